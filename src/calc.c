@@ -48,7 +48,7 @@ uint8_t StackPtr = 0;
 #define stack(x) Stack[(StackPtr + (x)) & (STACK_SIZE-1)]
 
 static void pop(){
-	copy_decn(&stack(STACK_X), &stack(STACK_T)); //duplicate t into x (which becomes new t)
+	copy_decn_xdata(&stack(STACK_X), &stack(STACK_T)); //duplicate t into x (which becomes new t)
 	StackPtr++; //adjust pointer
 }
 
@@ -75,7 +75,7 @@ static void do_binary_op(void (*f_ptr)(void)){
 	if (decn_is_nan(&stack(STACK_Y)) || decn_is_nan(&stack(STACK_X))){
 		set_dec80_NaN(&stack(STACK_Y));
 	} else {
-		copy_decn(&LastX, &stack(STACK_X)); //save LastX
+		copy_decn_xdata(&LastX, &stack(STACK_X)); //save LastX
 		copy_decn(&AccDecn, &stack(STACK_Y));
 		copy_decn(&BDecn, &stack(STACK_X));
 		f_ptr();
@@ -86,7 +86,7 @@ static void do_binary_op(void (*f_ptr)(void)){
 
 static void do_unary_op(void (*f_ptr)(void)){
 	if (!decn_is_nan(&stack(STACK_X))){
-		copy_decn(&LastX, &stack(STACK_X)); //save LastX
+		copy_decn_xdata(&LastX, &stack(STACK_X)); //save LastX
 		copy_decn(&AccDecn, &stack(STACK_X));
 		f_ptr();
 		copy_decn(&stack(STACK_X), &AccDecn);
@@ -104,14 +104,18 @@ void process_cmd(char cmd){
 				if (NoLift != 1){
 					StackPtr--;
 				}
-				copy_decn(&stack(STACK_X), &LastX);
+				copy_decn_xdata(&stack(STACK_X), &LastX);
 			} else { // +
 				do_binary_op(add_decn);
 			}
 		} break;
 		//////////
 		case '*':{
-			do_binary_op(mult_decn);
+			if (IsShiftedUp){ //y mod x
+				do_binary_op(fmod_decn);
+			} else {
+				do_binary_op(mult_decn);
+			}
 		} break;
 		//////////
 		case '-':{
@@ -143,18 +147,18 @@ void process_cmd(char cmd){
 				if (NoLift != 1){
 					StackPtr--;
 				}
-				copy_decn(&stack(STACK_X), &StoredDecn);
+				copy_decn_xdata(&stack(STACK_X), &StoredDecn);
 			} else { //Enter
 				if (!decn_is_nan(&stack(STACK_X))){
 					StackPtr--;
-					copy_decn(&stack(STACK_X), &stack(STACK_Y));
+					copy_decn_xdata(&stack(STACK_X), &stack(STACK_Y));
 				}
 			}
 		} break;
 		//////////
 		case '.':{
 			if (IsShiftedUp){ //STO
-				copy_decn(&StoredDecn, &stack(STACK_X));
+				copy_decn_xdata(&StoredDecn, &stack(STACK_X));
 			}
 		} break;
 		//////////
@@ -178,7 +182,7 @@ void process_cmd(char cmd){
 			} else { // swap
 				if (!decn_is_nan(&stack(STACK_X))){
 					copy_decn(&AccDecn, &stack(STACK_X));
-					copy_decn(&stack(STACK_X), &stack(STACK_Y));
+					copy_decn_xdata(&stack(STACK_X), &stack(STACK_Y));
 					copy_decn(&stack(STACK_Y), &AccDecn);
 				}
 			}
@@ -0,0 +1,17 @@
+# run the old tests, and compare their output with the reference "golden" output file
+# usage: cmake -DDECN_TEST=<decn_test executable> -DREFOUT=<reference file> -P compare_refout.cmake
+execute_process(
+	COMMAND ${DECN_TEST}
+	OUTPUT_FILE decn_test_out.txt
+	RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "${DECN_TEST} failed: ${result}")
+endif()
+execute_process(
+	COMMAND ${CMAKE_COMMAND} -E compare_files decn_test_out.txt ${REFOUT}
+	RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "decn_test_out.txt differs from ${REFOUT}")
+endif()
@@ -18,6 +18,7 @@
  *      Author: jeffrey
  */
 
+#include <stddef.h>
 #include "../utils.h"
 #include "../stack_debug.h"
 
@@ -36,6 +37,29 @@
 // #define DEBUG_EXP
 // #define DEBUG_EXP_ALL //even more verbose
 // #define DEBUG_SQRT
+// #define DEBUG_TRIG
+
+//use the assembly multiply-accumulate kernel for mult_decn() and fma_decn()
+// (8051 with binary digit100s only)
+#define DECN_ASM_MULT
+
+#if defined(DESKTOP) || defined(DECN_PACKED_BCD)
+#undef DECN_ASM_MULT
+#endif
+
+//features left out of the calculator firmware by default, to fit in its code space
+// (defining DECN_LARGE_CODE builds them, on the desktop or for larger parts such as the
+//  STC15F2K60S2: by default desktop results match the calculator's)
+#ifdef DECN_LARGE_CODE
+//fma_decn() keeps the full product (otherwise it multiplies, and then adds)
+#define DECN_FMA
+//fmod_decn() calculates 10^d mod b by squaring (otherwise it shifts in all d digits)
+#define DECN_FMOD_SQUARING
+//ln_decn() subtracts from ln(10) in fixed point for 1 <= x < 10, keeping precision near x = 1
+#define DECN_LN_NEAR_1
+//recip_decn() uses Newton-Raphson iterations from a table estimate (otherwise it divides 1 by x)
+#define DECN_RECIP_NEWTON
+#endif
 
 #ifndef DESKTOP
 //#undef EXTRA_CHECKS
@@ -49,10 +73,12 @@
 #undef DEBUG_EXP
 #undef DEBUG_EXP_ALL
 #undef DEBUG_SQRT
+#undef DEBUG_TRIG
 #endif
 
 #ifdef DESKTOP
 #include <stdio.h>
+#include <string.h>
 #endif
 
 #ifdef DESKTOP
@@ -61,45 +87,136 @@
 #define assert(x)
 #endif
 
+#ifdef DECN_CHECK_NORMALIZED
+#define assert_normalized(x) assert(decn_is_normalized(x))
+#else
+#define assert_normalized(x)
+#endif
+
 #ifdef DESKTOP
 static const uint8_t num_digits_display = DEC80_NUM_LSU*2;
 #else
 static const uint8_t num_digits_display = 16;
 #endif
 
+#ifdef DESKTOP
+static decn_ctx DefaultDecnCtx = { .num_lsu = DEC80_NUM_LSU };
+DECN_THREAD_LOCAL decn_ctx* DecnCtx = &DefaultDecnCtx;
+
+#define TmpDecn      (DecnCtx->tmp)
+#define Tmp2Decn     (DecnCtx->tmp2)
+#define Tmp3Decn     (DecnCtx->tmp3)
+#define Tmp4Decn     (DecnCtx->tmp4)
+#define TmpStackDecn (DecnCtx->tmp_stack)
+#define FixedDecn    (DecnCtx->fixed)
+#define Fixed2Decn   (DecnCtx->fixed2)
+#define NumTimes     (DecnCtx->num_times)
+#define DecnNumLsu   (DecnCtx->num_lsu)
+#else
 dec80 AccDecn;
 __idata dec80 BDecn;
-__idata dec80 TmpDecn; //used by add_decn() and mult_decn() and sqrt_decn()
-__idata dec80 Tmp2Decn; //used by recip_decn(), ln_decn(), exp_decn(), sqrt_decn(), and sincos_decn()
-__idata dec80 Tmp3Decn; //used by ln_decn(), exp_decn(), sqrt_decn(), and sincos_decn()
-__xdata dec80 Tmp4Decn; //used by sincos_decn()
-
-__xdata dec80 TmpStackDecn[4];
-#define TMP_STACK_SIZE  (sizeof TmpStackDecn / sizeof TmpStackDecn[0])
+__idata dec80 TmpDecn; //used by add_decn(), mult_decn(), div_decn(), and sqrt_decn()
+__idata dec80 Tmp2Decn; //used by recip_decn(), div_decn(), fmod_decn(), ln_decn(), exp_decn(), pow_decn(), sqrt_decn(), and trig functions
+__idata dec80 Tmp3Decn; //used by fmod_decn() and trig functions
+__xdata dec80 Tmp4Decn; //used by trig functions
+__xdata decn_fixed FixedDecn; //used by ln_decn(), exp_decn(), sqrt_decn(), and trig functions
+__xdata decn_fixed Fixed2Decn; //used by ln_decn(), sqrt_decn(), and trig functions
+__xdata uint8_t NumTimes[DECN_NUM_LN_A_ARR]; //used by ln_decn(), exp_decn(), and trig functions
+#define DecnNumLsu DEC80_NUM_LSU //working precision: always full (set_decn_precision() is desktop only)
+
+__xdata dec80 TmpStackDecn[DECN_TMP_STACK_SIZE];
 __idata uint8_t TmpStackPtr;
 
 __xdata char Buf[DECN_BUF_SIZE];
+#endif
+#define TMP_STACK_SIZE  (sizeof TmpStackDecn / sizeof TmpStackDecn[0])
+
+//scratch variables which would not fit on the 8051 stack
+// (on the desktop, these are on the stack, so each thread has its own)
+#ifdef DESKTOP
+#define STATIC_XDATA
+#else
+#define STATIC_XDATA static __xdata
+#endif
+
+#if !defined(DECN_PACKED_BCD) && defined(DECN_LARGE_CODE)
+__code const uint8_t DIGIT100_DIGITS[100] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+	0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
+	0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,
+	0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+	0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+	0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+	0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+	0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79,
+	0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+	0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99,
+};
+#endif
+
+#ifdef DECN_RECIP_NEWTON
+// 1
+static const dec80 DECN_ONE = {
+	0, DEC80_LSU(10,  0,  0,  0,  0,  0,  0,  0,  0)
+};
+#endif
+
+//constants below are generated by src/decn/proto/constants.cpp
+// dividing by a constant is done by multiplying by its reciprocal instead
 
 //ln(10) constant
 const dec80 DECN_LN_10 = {
-	0, {23,  2, 58, 50, 92, 99, 40, 45, 68}
+	0, DEC80_LSU(23,  2, 58, 50, 92, 99, 40, 45, 68)
 };
 
-// pi
-const dec80 DECN_PI = {
-	0, {31, 41, 59, 26, 53, 58, 97, 93, 24}
+//1/ln(10) constant (truncated, not rounded, see exp_decn())
+const dec80 DECN_1_LN_10 = {
+	-1 & 0x7fff, DEC80_LSU(43, 42, 94, 48, 19,  3, 25, 18, 27)
 };
 
-// pi/2
-const dec80 DECN_PI2 = {
-	0, {15, 70, 79, 63, 26, 79, 48, 96, 62}
+// pi
+const dec80 DECN_PI = {
+	0, DEC80_LSU(31, 41, 59, 26, 53, 58, 97, 93, 24)
 };
 
 // 180/pi = 1rad in degree
 const dec80 DECN_1RAD = {
-	1, {57, 29, 57, 79, 51, 30, 82, 32,  9}
+	1, DEC80_LSU(57, 29, 57, 79, 51, 30, 82, 32,  9)
+};
+
+// pi/180 = 1 degree in rad
+const dec80 DECN_1DEG = {
+	-2 & 0x7fff, DEC80_LSU(17, 45, 32, 92, 51, 99, 43, 29, 58)
 };
 
+#ifdef DESKTOP
+void init_decn_ctx(decn_ctx* ctx){
+	memset(ctx, 0, sizeof *ctx);
+	ctx->num_lsu = DEC80_NUM_LSU;
+}
+
+decn_ctx* use_decn_ctx(decn_ctx* ctx){
+	decn_ctx* prev = DecnCtx;
+	DecnCtx = ctx ? ctx : &DefaultDecnCtx;
+	return prev;
+}
+
+void apply_decn_ctx(decn_ctx* ctx, void (*op)(void)){
+	decn_ctx* prev = use_decn_ctx(ctx);
+	op();
+	use_decn_ctx(prev);
+}
+
+void set_decn_precision(uint8_t num_digits){
+	//rounded up to digit100s, plus a guard digit100
+	uint8_t num_lsu = (num_digits + 1) / 2 + 1;
+	if (num_digits == 0 || num_lsu > DEC80_NUM_LSU){
+		num_lsu = DEC80_NUM_LSU;
+	}
+	DecnNumLsu = num_lsu;
+}
+#endif
+
 void st_push_decn(const dec80 * const src)
 {
 	copy_decn(&TmpStackDecn[TmpStackPtr], src);
@@ -132,6 +249,51 @@ void copy_decn(dec80* const dest, const dec80* const src){
 	}
 }
 
+//on the 8051, copy_decn() takes generic pointers, so every byte goes through
+// __gptrget/__gptrput (checking the memory space at run time)
+//copy_reg() is for copies between the internal RAM registers (AccDecn, BDecn,
+// TmpDecn, Tmp2Decn, Tmp3Decn), which only need @r0/@r1
+static void copy_reg(__idata dec80* const dest, __idata const dec80* const src){
+	uint8_t i;
+
+	dest->exponent = src->exponent;
+	for (i = 0; i < DEC80_NUM_LSU; i++){
+		dest->lsu[i] = src->lsu[i];
+	}
+}
+
+#ifdef DESKTOP
+void copy_decn_xdata(__xdata dec80* const dest, __xdata const dec80* const src){
+	copy_decn(dest, src);
+}
+#else
+_Static_assert(sizeof(dec80) == 11, "copy_decn_xdata() copies 11 bytes");
+
+//uses the STC15's second data pointer (selected by DPS, bit 0 of AUXR1),
+// so that neither pointer has to be reloaded for each byte
+//(an interrupt handler only saves/restores the currently selected DPTR, and
+// DPTR0 is selected again before returning)
+void copy_decn_xdata(__xdata dec80* const dest, __xdata const dec80* const src) __naked {
+	dest; src; // keep compiler from complaining
+	__asm
+		mov  r7, #11 ; sizeof(dec80)
+		orl  0xa2, #0x01 ; DPTR1 = src (DPTR0 = dest)
+		mov  dpl, _copy_decn_xdata_PARM_2
+		mov  dph, (_copy_decn_xdata_PARM_2 + 1)
+	00001$:
+		movx a, @dptr
+		inc  dptr
+		xrl  0xa2, #0x01 ; DPTR0
+		movx @dptr, a
+		inc  dptr
+		xrl  0xa2, #0x01 ; DPTR1
+		djnz r7, 00001$
+		anl  0xa2, #0xfe ; DPTR0
+		ret
+	__endasm;
+}
+#endif
+
 exp_t get_exponent(const dec80* const x){
 	exp_t exponent = x->exponent;
 #ifdef EXP16
@@ -167,67 +329,163 @@ void set_exponent(dec80* acc, exp_t exponent, uint8_t num_is_neg){
 	acc->exponent = exponent;
 }
 
-static void zero_remaining_dec80(dec80* dest, uint8_t digit100){
+static void zero_remaining_dec80(__idata dec80* dest, uint8_t digit100){
 	for ( ; digit100 < DEC80_NUM_LSU; digit100++){
 		dest->lsu[digit100] = 0;
 	}
 }
 
 
-static uint8_t shift_high = 0, shift_low = 0, shift_old = 0;
-static uint8_t shift_i;
-static void shift_right(dec80* x){
-	shift_high = shift_low = shift_old = 0;
+static void shift_right(__idata dec80* x){
+	uint8_t shift_high, shift_low, shift_old = 0;
+	uint8_t shift_i;
 	for (shift_i = 0; shift_i < DEC80_NUM_LSU; shift_i++){
-		shift_high = x->lsu[shift_i] / 10;
-		shift_low = x->lsu[shift_i] % 10;
-		x->lsu[shift_i] = shift_high + ( shift_old*10);
+		shift_high = DIGIT100_HI(x->lsu[shift_i]);
+		shift_low = DIGIT100_LO(x->lsu[shift_i]);
+		x->lsu[shift_i] = DIGIT100_MAKE(shift_old, shift_high);
 		shift_old = shift_low;
 	}
 }
 
-static void shift_left(dec80* x){
-	shift_high = shift_low = shift_old = 0;
+//shift right by n digits: whole digit100s are moved at once,
+// then at most a single digit shift is needed
+static void shift_right_n(__idata dec80* x, exp_t n){
+	uint8_t i, digit100s;
+	if (n >= DEC80_NUM_LSU * 2){
+		//shifted out completely
+		zero_remaining_dec80(x, 0);
+		return;
+	}
+	digit100s = n / 2;
+	if (digit100s != 0){
+		for (i = DEC80_NUM_LSU - 1; i >= digit100s; i--){
+			x->lsu[i] = x->lsu[i - digit100s];
+		}
+		for (i = 0; i < digit100s; i++){
+			x->lsu[i] = 0;
+		}
+	}
+	if (n & 1){
+		shift_right(x);
+	}
+}
+
+static void shift_left(__idata dec80* x){
+	uint8_t shift_high, shift_low, shift_old = 0;
+	uint8_t shift_i;
 	for (shift_i = DEC80_NUM_LSU - 1; shift_i < 255; shift_i--){
-		shift_high = x->lsu[shift_i] / 10;
-		shift_low = x->lsu[shift_i] % 10;
-		x->lsu[shift_i] = shift_old + ( shift_low*10);
+		shift_high = DIGIT100_HI(x->lsu[shift_i]);
+		shift_low = DIGIT100_LO(x->lsu[shift_i]);
+		x->lsu[shift_i] = DIGIT100_MAKE(shift_low, shift_old);
 		shift_old = shift_high;
 	}
 }
 
-void remove_leading_zeros(dec80* x){
-	uint8_t digit100;
-	uint8_t is_negative = (x->exponent < 0);
-	exp_t exponent = get_exponent(x);
+#ifdef DECN_PACKED_BCD
+#ifndef DESKTOP
+static __bit BcdCarry;
+
+//a + b + BcdCarry for packed BCD digit100s (BcdCarry is updated)
+static uint8_t bcd_addc(uint8_t a, uint8_t b) __naked {
+	a; b; // keep compiler from complaining
+	__asm
+		mov  a, dpl
+		mov  c, _BcdCarry
+		addc a, _bcd_addc_PARM_2
+		da   a
+		mov  _BcdCarry, c
+		mov  dpl, a
+		ret
+	__endasm;
+}
+#endif
+#endif //DECN_PACKED_BCD
 
-	stack_debug(0x02);
-	//find first non-zero digit100
-	for (digit100 = 0; digit100 < DEC80_NUM_LSU; digit100++){
-		if (x->lsu[digit100] != 0){
-			break;
+//acc += x for all digit100s, returns carry out
+static uint8_t add_digit100s(__idata dec80* acc, __idata const dec80* x, uint8_t carry){
+	int8_t i;
+#if defined(DECN_PACKED_BCD) && !defined(DESKTOP)
+	BcdCarry = carry;
+#endif
+	for (i = DEC80_NUM_LSU - 1; i >= 0; i--){
+#if !defined(DECN_PACKED_BCD) || defined(DESKTOP)
+		uint8_t digit100 = DIGIT100_VAL(acc->lsu[i]) + DIGIT100_VAL(x->lsu[i]) + carry;
+		carry = (digit100 >= 100);
+		if (carry){
+			digit100 -= 100;
+		}
+		acc->lsu[i] = DIGIT100(digit100);
+#else
+		acc->lsu[i] = bcd_addc(acc->lsu[i], x->lsu[i]);
+#endif
+	}
+#if defined(DECN_PACKED_BCD) && !defined(DESKTOP)
+	carry = BcdCarry;
+#endif
+	return carry;
+}
+
+//AccDecn.lsu[] -= x->lsu[], returns borrow out
+// for DECN_PACKED_BCD, x must hold the 99..99 complement of the number to subtract
+static uint8_t sub_digit100s(__idata const dec80* x){
+#ifdef DECN_PACKED_BCD
+	//adding the 10's complement: no carry out means the result is negative
+	return !add_digit100s(&AccDecn, x, 1);
+#else
+	int8_t i;
+	uint8_t borrow = 0;
+	for (i = DEC80_NUM_LSU - 1; i >= 0; i--){
+		//same form as add_digit100s(): a single conditional add, which compilers
+		// can do without a branch
+		uint8_t digit100 = AccDecn.lsu[i] - x->lsu[i] - borrow;
+		borrow = (AccDecn.lsu[i] < x->lsu[i] + borrow);
+		if (borrow){
+			digit100 += 100;
 		}
+		assert(digit100 < 100);
+		AccDecn.lsu[i] = digit100;
 	}
-	exponent -= digit100 * 2; //base 100
+	return borrow;
+#endif
+}
 
+//shift x left until the most significant digit is non-zero (x must not be 0),
+// returns the number of digits shifted (the exponent isn't changed)
+static uint8_t shift_out_leading_zeros(__idata dec80* x){
+	uint8_t digit100;
+	uint8_t shift;
+	//find first non-zero digit100
+	for (digit100 = 0; digit100 < DEC80_NUM_LSU - 1 && x->lsu[digit100] == 0; digit100++){
+	}
+	shift = digit100 * 2; //base 100
 	//copy digit100s left if needed
-	if (digit100 != 0 && digit100 < DEC80_NUM_LSU){ //found non-zero digit100
+	if (digit100 != 0){
 		uint8_t i;
-		//copy digit100s
 		for (i = 0; digit100 < DEC80_NUM_LSU; i++, digit100++){
 			x->lsu[i] = x->lsu[digit100];
 		}
-		//zero out remaining digit100s, now that number left-aligned
 		zero_remaining_dec80(x, i);
 	}
-
 	//ensure MSdigit in MSdigit100 is > 0
-	if (x->lsu[0] < 10) {
+	if (DIGIT100_HI(x->lsu[0]) == 0) {
 		shift_left(x);
-		exponent--;
+		shift++;
+	}
+	return shift;
+}
+
+void remove_leading_zeros(__idata dec80* x){
+	uint8_t is_negative = (x->exponent < 0);
+
+	stack_debug(0x02);
+	if (DIGIT100_HI(x->lsu[0]) != 0){
+		return; //already normalized (or NaN)
+	}
+	if (decn_is_zero(x)){
+		set_dec80_zero(x);
+		return;
 	}
-	//write back exponent
-	set_exponent(x, exponent, is_negative);
+	set_exponent(x, get_exponent(x) - shift_out_leading_zeros(x), is_negative);
 }
 
 void build_dec80(__xdata const char* signif_str, __xdata exp_t exponent){
@@ -283,7 +541,7 @@ void build_dec80(__xdata const char* signif_str, __xdata exp_t exponent){
 		} else if (signif_str[i] >= '1' && signif_str[i] <= '9'){
 			if (nibble_i < DEC80_NUM_LSU*2){
 				if (nibble_i & 1) { //odd
-					AccDecn.lsu[nibble_i/2] = save_nibble * 10 + (signif_str[i] - '0');
+					AccDecn.lsu[nibble_i/2] = DIGIT100_MAKE(save_nibble, signif_str[i] - '0');
 				} else {
 					save_nibble = signif_str[i] - '0';
 				}
@@ -315,7 +573,7 @@ void build_dec80(__xdata const char* signif_str, __xdata exp_t exponent){
 			if (!IS_ZERO(curr_sign)){ //non-zero value
 				if (nibble_i < DEC80_NUM_LSU*2){
 					if (nibble_i & 1) { //odd
-						AccDecn.lsu[nibble_i/2] = save_nibble * 10 + 0;
+						AccDecn.lsu[nibble_i/2] = DIGIT100_MAKE(save_nibble, 0);
 					} else {
 						save_nibble = 0;
 					}
@@ -347,7 +605,7 @@ void build_dec80(__xdata const char* signif_str, __xdata exp_t exponent){
 				//write out saved nibble, if it exists
 				// (saved while nibble_i even, nibble_i then incremented to odd)
 				if (nibble_i & 1){ //odd
-					AccDecn.lsu[nibble_i/2] = save_nibble * 10;
+					AccDecn.lsu[nibble_i/2] = DIGIT100_MAKE(save_nibble, 0);
 					nibble_i++; //increment for zeroing out
 				}
 				//zero out any old data
@@ -387,7 +645,7 @@ void build_dec80(__xdata const char* signif_str, __xdata exp_t exponent){
 				        num_lr_points, new_exponent, curr_sign, exponent);
 				printf("   ");
 				for (i = 0; i < DEC80_NUM_LSU; i++){
-					printf("%02d,", AccDecn.lsu[i]);
+					printf("%02d,", DIGIT100_VAL(AccDecn.lsu[i]));
 				}
 				printf("\n");
 #endif
@@ -424,7 +682,7 @@ void set_dec80_zero(dec80* dest){
 
 void set_decn_one(dec80* dest){
 	set_dec80_zero(dest);
-	dest->lsu[0] = 10;
+	dest->lsu[0] = DIGIT100(10);
 }
 
 uint8_t decn_is_zero(const dec80* x){
@@ -451,6 +709,12 @@ uint8_t decn_is_nan(const dec80* x){
 	return 1;
 }
 
+#ifdef DECN_CHECK_NORMALIZED
+uint8_t decn_is_normalized(const dec80* x){
+	return DIGIT100_HI(x->lsu[0]) != 0 || decn_is_zero(x) || decn_is_nan(x);
+}
+#endif
+
 #ifdef EXTRA_CHECKS
 void set_dec80_NaN(dec80* dest){
 	uint8_t i;
@@ -476,59 +740,26 @@ void negate_decn(dec80* x){
 	(x->exponent) ^= xor_val;
 }
 
-static int8_t compare_magn(void){ //returns a<b: -1, a==b: 0, a>b: 1
-	uint8_t a_i, b_i;
-	exp_t a_exp=0, b_exp=0;
-	int8_t a_signif_b = 0; //a<b: -1, a==b: 0, a>b: 1
-	static __xdata dec80 a_tmp, b_tmp;
-	//copy
-	copy_decn(&a_tmp, &AccDecn);
-	copy_decn(&b_tmp, &BDecn);
-	//normalize
-	remove_leading_zeros(&a_tmp);
-	remove_leading_zeros(&b_tmp);
-	//compare signifcands while tracking magnitude
-	for (
-		a_i = 0, b_i = 0;
-		a_i < DEC80_NUM_LSU;
-		a_i++, b_i++, a_exp+=2, b_exp+=2
-		)
-	{
-		//set signif. inequality if this is first digit that is different
-		if (a_signif_b == 0 && (a_tmp.lsu[a_i] < b_tmp.lsu[b_i])){
-#ifdef DEBUG_COMPARE_MAGN
-			printf("a_signif_b -1: a.lsu[%d]=%d, b.lsu[%d]=%d\n",
-			        a_i, a_tmp.lsu[a_i], b_i, b_tmp.lsu[b_i]);
-#endif
-			a_signif_b = -1;
-		} else if (a_signif_b == 0 && (a_tmp.lsu[a_i] > b_tmp.lsu[b_i])){
+//returns |a|<|b|: -1, |a|==|b|: 0, |a|>|b|: 1
+// (both must be normalized and non-zero, so that exponents can be compared first)
+static int8_t compare_magn(void){
+	uint8_t i;
+	exp_t a_exp = get_exponent(&AccDecn);
+	exp_t b_exp = get_exponent(&BDecn);
+	if (a_exp != b_exp){
+		return (a_exp > b_exp) ? 1 : -1;
+	}
+	//exponents equal, compare by significand
+	for (i = 0; i < DEC80_NUM_LSU; i++){
+		if (AccDecn.lsu[i] != BDecn.lsu[i]){
 #ifdef DEBUG_COMPARE_MAGN
-			printf("a_signif_b  1: a.lsu[%d]=%d, b.lsu[%d]=%d\n",
-			        a_i, a_tmp.lsu[a_i], b_i, b_tmp.lsu[b_i]);
+			printf("a_signif_b: a.lsu[%d]=%d, b.lsu[%d]=%d\n",
+			        i, AccDecn.lsu[i], i, BDecn.lsu[i]);
 #endif
-			a_signif_b = 1;
+			return (AccDecn.lsu[i] > BDecn.lsu[i]) ? 1 : -1;
 		}
 	}
-	//calculate exponents
-	a_exp += get_exponent(&a_tmp);
-	b_exp += get_exponent(&b_tmp);
-	//compare exponents
-	if (a_exp > b_exp){
-#ifdef DEBUG
-		printf("a_exp > b_exp\n");
-#endif
-		return 1;
-	} else if (a_exp < b_exp){
-#ifdef DEBUG
-		printf("a_exp < b_exp\n");
-#endif
-		return -1;
-	}
-	//exponents equal, compare by significand
-#ifdef DEBUG
-		printf("a_signif_b (%d)\n", a_signif_b);
-#endif
-	return a_signif_b;
+	return 0;
 }
 
 #ifdef USE_COMPARE_DECN
@@ -564,260 +795,341 @@ static int8_t compare_decn(void){ //returns a<b: -1, a==b: 0, a>b: 1
 }
 #endif //USE_COMPARE_DECN
 
-//WARNING: for add_decn() and sub_mag() functions only
-//acc and the number from which exponent was taken MUST be stripped of leading 0s first
-//rescales acc up to exponent (increase exponent of acc, while shifting right)
-//the actual value of acc->exponent remains unchanged
-static void _incr_exp(dec80* acc, exp_t exponent){
-	exp_t curr_exp = get_exponent(acc);
-#ifdef DEBUG_ADD
-	uint8_t is_neg = (acc->exponent < 0);
-	printf("   (is_neg,curr_exp,exponent)=(%d,%d,%d)\n",
-	        is_neg, curr_exp, exponent);
-#endif
-	assert(exponent > curr_exp);
-	while (curr_exp != exponent){
-		//shift right
-		shift_right(acc);
-		curr_exp++;
-	}
-
-	//curr_exp does NOT get written back to acc->exponent
-}
-
 //for internal use only,
-//AccDecn must be larger than BDecn in absolute value
+//|AccDecn| must be larger than |BDecn|, and BDecn must already be shifted right by
+// the exponent difference
 //subtract by equal addition algorithm
-static void sub_mag(){
-	int8_t i;
-	uint8_t carry = 0;
-	//normalize
-	remove_leading_zeros(&AccDecn);
-	remove_leading_zeros(&BDecn);
-	if (get_exponent(&AccDecn) != get_exponent(&BDecn)){
-		_incr_exp(&BDecn, get_exponent(&AccDecn));
-	}
-#ifdef DEBUG_ADD
-	decn_to_str_complete(&tmp);
-	printf("        incr_exp tmp: %s\n", Buf);
-#endif
+static void sub_mag(void){
+	uint8_t carry;
 	//do subtraction
-	for (i = DEC80_NUM_LSU - 1; i >=0; i--){
-		uint8_t digit100;
-		if (AccDecn.lsu[i] >= (BDecn.lsu[i] + carry)){
-			digit100 = AccDecn.lsu[i] - (BDecn.lsu[i] + carry);
-			carry = 0;
-		} else {
-			digit100 = AccDecn.lsu[i] + 100 - (BDecn.lsu[i] + carry);
-			carry = 1;
-		}
-		assert(digit100 < 100);
-		      AccDecn.lsu[i] = digit100;
+#ifdef DECN_PACKED_BCD
+	//subtract by adding 10's complement of x
+	// (BDecn gets restored by add_decn())
+	for (carry = 0; carry < DEC80_NUM_LSU; carry++){
+		BDecn.lsu[carry] = 0x99 - BDecn.lsu[carry];
 	}
-	assert(carry == 0); //shouldn't be carry out if |acc| > |x|
+#endif
+	carry = sub_digit100s(&BDecn);
+	assert(carry == 0); //shouldn't be borrow out if |acc| > |x|
 }
 
+//the sign and exponent of both operands are unpacked once into locals, and only the
+// result's exponent is packed back (get_exponent()/set_exponent() need to mask and
+// sign extend the 16 bit exponent, which is expensive on the 8051)
 void add_decn(void){
-	int8_t rel;
-	uint8_t carry = 0;
-	int8_t i;
+	uint8_t carry;
+	exp_t exp_diff;
+	exp_t res_exp; //unpacked exponent of the result
+	uint8_t res_is_neg; //unpacked sign of the result
 
+#ifdef EXTRA_CHECKS
+	if (decn_is_nan(&AccDecn) || decn_is_nan(&BDecn)) {
+		set_dec80_NaN(&AccDecn);
+		return;
+	}
+#endif
 	//check if zero
 	if (decn_is_zero(&BDecn)){
 		return;
 	} else if (decn_is_zero(&AccDecn)){
-		copy_decn(&AccDecn, &BDecn);
+		copy_reg(&AccDecn, &BDecn);
+		return;
+	}
+	assert_normalized(&AccDecn);
+	assert_normalized(&BDecn);
+	//check if smaller operand falls entirely below the 18 digit window, or below the
+	// working precision (aligning would shift it out completely, and numbers are truncated)
+	res_exp = get_exponent(&AccDecn);
+	exp_diff = res_exp - get_exponent(&BDecn);
+	if (exp_diff >= DecnNumLsu * 2){
+		return;
+	} else if (exp_diff <= -DecnNumLsu * 2){
+		copy_reg(&AccDecn, &BDecn);
 		return;
 	}
 	//save b for restoring later
 	//n.b. don't use TmpStackDecn here, it is called quite often. So you'd need to increase TMP_STACK_SIZE
-	copy_decn(&TmpDecn, &BDecn);
-	//handle cases where signs differ
-	if (AccDecn.exponent < 0 && BDecn.exponent >= 0){
-		// -acc, +x
-		rel = compare_magn();
-		if (rel == 1){
-#ifdef DEBUG_ADD
-			printf("|-acc| > |+x|\n");
-#endif
-			sub_mag();
-		} else if (rel == -1){
-#ifdef DEBUG_ADD
-			printf("|-acc| < |+x|\n");
-#endif
-			copy_decn(&BDecn, &AccDecn);
-			copy_decn(&AccDecn, &TmpDecn);
-			sub_mag();
-		} else { //equal
-#ifdef DEBUG_ADD
-			printf("|-acc| == |+x|\n");
-#endif
-			set_dec80_zero(&AccDecn);
+	copy_reg(&TmpDecn, &BDecn);
+	res_is_neg = (AccDecn.exponent < 0);
+	if (res_is_neg != (BDecn.exponent < 0)){
+		//signs differ: subtract the smaller magnitude from the larger one
+		int8_t rel;
+		if (exp_diff != 0){
+			rel = (exp_diff > 0) ? 1 : -1;
+		} else {
+			rel = compare_magn();
 		}
-		//restore b
-		copy_decn(&BDecn, &TmpDecn);
-
-		return;
-	} else if (AccDecn.exponent >= 0 && BDecn.exponent < 0){
-		// +acc, -x
-		rel = compare_magn();
-		if (rel == 1){
-#ifdef DEBUG_ADD
-			printf("|+acc| > |-x|\n");
-#endif
-			sub_mag();
-		} else if (rel == -1){
+		if (rel == 0){
 #ifdef DEBUG_ADD
-			printf("|+acc| < |-x|\n");
+			printf("|acc| == |x|\n");
 #endif
-			copy_decn(&BDecn, &AccDecn);
-			copy_decn(&AccDecn, &TmpDecn);
-			sub_mag();
-		} else { //equal
+			set_dec80_zero(&AccDecn);
+			//restore b
+			copy_reg(&BDecn, &TmpDecn);
+			return;
+		} else if (rel < 0){
 #ifdef DEBUG_ADD
-			printf("|+acc| == |-x|\n");
+			printf("|acc| < |x|\n");
 #endif
-			set_dec80_zero(&AccDecn);
+			copy_reg(&BDecn, &AccDecn);
+			copy_reg(&AccDecn, &TmpDecn);
+			res_is_neg = !res_is_neg;
+			res_exp -= exp_diff;
+			exp_diff = -exp_diff;
+		}
+		shift_right_n(&BDecn, exp_diff);
+		sub_mag();
+		//leading digits may have cancelled
+		res_exp -= shift_out_leading_zeros(&AccDecn);
+	} else {
+		//signs are the same, align to the larger exponent
+		if (exp_diff > 0){
+			shift_right_n(&BDecn, exp_diff);
+		} else if (exp_diff < 0){
+			shift_right_n(&AccDecn, -exp_diff);
+			res_exp -= exp_diff;
 		}
-		//restore b
-		copy_decn(&BDecn, &TmpDecn);
-
-		return;
-	}
-	//signs must now be the same, begin adding
-	//normalize
-	remove_leading_zeros(&AccDecn);
-	remove_leading_zeros(&BDecn);
 #ifdef DEBUG_ADD
-	decn_to_str_complete(&AccDecn);
-	printf("        rem_leading_zeros acc: %s\n", Buf);
-	decn_to_str_complete(&BDecn);
-	printf("        rem_leading_zeros tmp: %s\n", Buf);
-#endif
-	if (get_exponent(&AccDecn) > get_exponent(&BDecn)){
-		_incr_exp(&BDecn, get_exponent(&AccDecn));
-	} else if (get_exponent(&AccDecn) < get_exponent(&BDecn)){
-		//shift significand and adjust exponent to match
-		for (i = 0; i < get_exponent(&BDecn) - get_exponent(&AccDecn); i++){
+		decn_to_str_complete(&AccDecn);
+		printf("        incr_exp acc: %s\n", Buf);
+		decn_to_str_complete(&BDecn);
+		printf("        incr_exp tmp: %s\n", Buf);
+#endif
+		//do addition
+		carry = add_digit100s(&AccDecn, &BDecn, 0);
+		//may need to rescale number
+		if (carry > 0){
+			//shift right
 			shift_right(&AccDecn);
+			AccDecn.lsu[0] += DIGIT100(10); //carry gets shifted into most significant digit
+			res_exp++;
+			if (res_exp > DEC80_MAX_EXP){
+				set_dec80_NaN(&AccDecn);
+				//restore b
+				copy_reg(&BDecn, &TmpDecn);
+				return;
+			}
 		}
-		set_exponent(&AccDecn, get_exponent(&BDecn), (AccDecn.exponent < 0));
-	}
-#ifdef DEBUG_ADD
-	decn_to_str_complete(&AccDecn);
-	printf("        incr_exp acc: %s\n", Buf);
-	decn_to_str_complete(&BDecn);
-	printf("        incr_exp tmp: %s\n", Buf);
-#endif
-	//do addition
-	for (i = DEC80_NUM_LSU - 1; i >= 0; i--){
-		uint8_t digit100 = AccDecn.lsu[i] + BDecn.lsu[i] + carry;
-		AccDecn.lsu[i] = digit100 % 100;
-		carry = digit100 / 100;
-		assert(carry <= 1);
-	}
-	//may need to rescale number
-	if (carry > 0){
-		exp_t curr_exp = get_exponent(&AccDecn);
-		assert(carry == 1);
-		rel = (AccDecn.exponent < 0); //is_neg?
-		//shift right
-		shift_right(&AccDecn);
-		AccDecn.lsu[0] += 10; //carry gets shifted into most significant digit
-		curr_exp++;
-		//track sign
-		set_exponent(&AccDecn, curr_exp, rel); //rel==is_neg?
 	}
+	set_exponent(&AccDecn, res_exp, res_is_neg);
 
 	//restore b
-	copy_decn(&BDecn, &TmpDecn);
+	copy_reg(&BDecn, &TmpDecn);
 }
 
-//AccDecn *= BDecn
-// (the BDecn register is preserved)
-void mult_decn(void){
+#ifdef DECN_ASM_MULT
+_Static_assert(offsetof(dec80, lsu) == 2, "mult_column() reads lsu[] at _AccDecn + 2 and _BDecn + 2");
+
+static __data uint16_t MultCarry; //carry into the next column of mult_column()
+
+//returns digit100 k of (AccDecn * BDecn + MultCarry), and sets MultCarry to the carry
+// out of the column: see the C version below
+//the column sum (< 2^17) is kept in r4:r3:r2, AccDecn.lsu[i] is read through r0 and
+// BDecn.lsu[k - i] through r1 (lsu[] starts at offset 2)
+static uint8_t mult_column(uint8_t k) __naked {
+	k; // keep compiler from complaining
+	__asm
+		mov  r2, _MultCarry
+		mov  r3, (_MultCarry + 1)
+		mov  r4, #0
+		mov  a, dpl
+		add  a, #(0x100 - 8)
+		jc   00001$
+		; k < 8: i = 0..k, j = k..0
+		mov  r0, #(_AccDecn + 2)
+		mov  a, dpl
+		add  a, #(_BDecn + 2)
+		mov  r1, a
+		mov  r5, dpl
+		inc  r5
+		sjmp 00002$
+	00001$:
+		; k >= 8: i = k-8..8, j = 8..k-8
+		mov  r7, a
+		add  a, #(_AccDecn + 2)
+		mov  r0, a
+		mov  r1, #(_BDecn + 2 + 8)
+		mov  a, #9
+		clr  c
+		subb a, r7
+		mov  r5, a
+	00002$:
+		mov  a, @r0
+		mov  b, @r1
+		mul  ab
+		add  a, r2
+		mov  r2, a
+		mov  a, b
+		addc a, r3
+		mov  r3, a
+		clr  a
+		addc a, r4
+		mov  r4, a
+		inc  r0
+		dec  r1
+		djnz r5, 00002$
+		; u = sum >> 2 in r3:r5 (sum & 0xff stays in r2)
+		mov  a, r2
+		mov  r5, a
+		mov  r6, #2
+	00003$:
+		clr  c
+		mov  a, r4
+		rrc  a
+		mov  r4, a
+		mov  a, r3
+		rrc  a
+		mov  r3, a
+		mov  a, r5
+		rrc  a
+		mov  r5, a
+		djnz r6, 00003$
+		; bytes 3:2 of u * 0x51ec in r4:r7
+		mov  a, r5
+		mov  b, #0xec
+		mul  ab
+		mov  r6, b
+		mov  a, r5
+		mov  b, #0x51
+		mul  ab
+		add  a, r6
+		mov  r6, a
+		clr  a
+		addc a, b
+		mov  r7, a
+		mov  a, r3
+		mov  b, #0xec
+		mul  ab
+		add  a, r6
+		mov  a, b
+		addc a, r7
+		mov  r7, a
+		mov  a, r3
+		mov  b, #0x51
+		mul  ab
+		add  a, r7
+		mov  r7, a
+		clr  a
+		addc a, b
+		mov  r4, a
+		; carry = (u * 0x51ec) >> 19
+		mov  r6, #3
+	00004$:
+		clr  c
+		mov  a, r4
+		rrc  a
+		mov  r4, a
+		mov  a, r7
+		rrc  a
+		mov  r7, a
+		djnz r6, 00004$
+		mov  _MultCarry, r7
+		mov  (_MultCarry + 1), r4
+		; digit100 = sum - carry * 100 (only the low byte is needed)
+		mov  a, r7
+		mov  b, #100
+		mul  ab
+		xch  a, r2
+		clr  c
+		subb a, r2
+		mov  dpl, a
+		ret
+	__endasm;
+}
+#else
+#ifdef DESKTOP
+static DECN_THREAD_LOCAL uint16_t MultCarry; //carry into the next column of mult_column()
+#else
+static __data uint16_t MultCarry; //carry into the next column of mult_column()
+#endif
+
+//returns digit100 k of (AccDecn * BDecn + MultCarry), and sets MultCarry to the carry
+// out of the column
+//sum all partial products of the column at once, and only then divide by 100 (same
+// arithmetic as the 8051 assembly version)
+//the column sum needs 17 bits, so it is accumulated in a uint32_t: there are at most
+// 9 partial products of at most 99*99, and the carry in is at most 890, so
+// column <= 9*99*99 + 890 == 89099 (and the carry out is at most 890 again)
+static uint8_t mult_column(uint8_t k){
 	int8_t i, j;
-	uint8_t carry = 0;
+	uint32_t column = MultCarry;
+	uint16_t quarter;
+	// i + j == k
+	i = (k < DEC80_NUM_LSU) ? 0 : k - (DEC80_NUM_LSU - 1);
+	for (j = k - i; i < DEC80_NUM_LSU && j >= 0; i++, j--){
+		column += (uint16_t) DIGIT100_VAL(AccDecn.lsu[i]) * DIGIT100_VAL(BDecn.lsu[j]);
+	}
+	//column / 100 == (column / 4) / 25: multiply by 2^19 / 25 (rounded up) instead of
+	// dividing, which is exact for column / 4 < 43690 (column / 4 <= 22274 here)
+	quarter = column >> 2;
+	MultCarry = ((uint32_t) quarter * 20972) >> 19;
+	return (uint8_t) column - (uint8_t) (MultCarry * 100);
+}
+#endif //DECN_ASM_MULT
+
+//multiply the significands of AccDecn and BDecn column-wise (Comba): sum all partial
+// products for a digit100 of the result at once, and only then propagate the carry
+//the most significant num_kept of the 17 columns are stored in dst (the lower ones
+// are still needed for their carries, so the result is truncated exactly)
+//with fewer than DEC80_NUM_LSU kept (reduced working precision), the columns below
+// the first one not kept are skipped, and their carries are lost (the result is
+// then only accurate to about num_kept digit100s)
+//returns the carry out of the most significant column (< 100)
+static uint8_t mult_columns(uint8_t* dst, int8_t num_kept){
+	int8_t k;
+	uint8_t digit100;
+	MultCarry = 0;
+	k = (num_kept < DEC80_NUM_LSU) ? num_kept : 2 * (DEC80_NUM_LSU - 1);
+	for ( ; k >= 0; k--){
+		digit100 = mult_column(k);
+		if (k < num_kept){
+			dst[k] = DIGIT100(digit100);
+		}
+#ifdef DEBUG_MULT_ALL
+		printf("\n%d: carry %u", k, MultCarry);
+#endif
+	}
+	assert(MultCarry < 100);
+	return MultCarry;
+}
+
+//AccDecn = x * y, given the most significant digit100s of the product of the
+// significands in TmpDecn, and the carry out of them (see mult_columns())
+static void mult_finish(const dec80* x, const dec80* y, uint8_t carry){
 	uint8_t is_neg;
 	exp_t new_exponent;
-#ifdef EXTRA_CHECKS
-	if (decn_is_nan(&AccDecn) || decn_is_nan(&BDecn)) {
-		set_dec80_NaN(&AccDecn);
-		return;
-	}
-#endif
-	//initialize values
-	set_dec80_zero(&TmpDecn);
-	//normalize
-	remove_leading_zeros(&AccDecn);
-	remove_leading_zeros(&BDecn);
 	//store new sign
 #ifdef EXP16
-	if ((AccDecn.exponent & 0x8000) ^ (BDecn.exponent & 0x8000)){ //signs differ
+	if ((x->exponent & 0x8000) ^ (y->exponent & 0x8000)){ //signs differ
 #else
-		if ((AccDecn.exponent & 0x80) ^ (BDecn.exponent & 0x80)){ //signs differ
+	if ((x->exponent & 0x80) ^ (y->exponent & 0x80)){ //signs differ
 #endif
 		is_neg = 1;
 	} else {
 		is_neg = 0;
 	}
 	//calculate new exponent
-	new_exponent = get_exponent(&AccDecn) + get_exponent(&BDecn);
+	new_exponent = get_exponent(x) + get_exponent(y);
 #ifdef DEBUG_MULT
-	printf("\n a_exp: %d, b_exp: %d", get_exponent(&AccDecn), get_exponent(&BDecn));
+	printf("\n a_exp: %d, b_exp: %d", get_exponent(x), get_exponent(y));
 	printf("\n new exponent: %d, is_neg: %u", new_exponent, is_neg);
 #endif
-	//do multiply
-	for (i = DEC80_NUM_LSU - 1; i >= 0; i--){
-		//partial product
-		for (j = DEC80_NUM_LSU - 1; j >= 0; j--){
-			uint16_t digit100 = TmpDecn.lsu[j] + (BDecn.lsu[i] * AccDecn.lsu[j]) + carry;
-			TmpDecn.lsu[j] = digit100 % 100;
-			carry = digit100 / 100;
-			assert(carry < 100);
-		}
-#ifdef DEBUG_MULT_ALL
-		printf("\n%d:", i);
-		printf("\n      acc:");
-		for (j = 0; j < DEC80_NUM_LSU; j++){
-			printf(" %3d", AccDecn.lsu[j]);
-		}
-		printf("\n        x:");
-		for (j = 0; j < DEC80_NUM_LSU; j++){
-			if (j == i)
-				printf(" %3d", BDecn.lsu[j]);
-			else
-				printf("    ");
-		}
-#endif
-#ifdef DEBUG_MULT
-		printf("\n  TmpDecn:");
-		for (j = 0; j < DEC80_NUM_LSU; j++){
-			printf(" %3d", TmpDecn.lsu[j]);
-		}
-		printf("\ncarry:%d", carry);
-#endif
-		if (i != 0){ //handle last carry separately later, no final shift
-			//shift
-			shift_right(&TmpDecn);
-			shift_right(&TmpDecn);
-			//add back carry to MSdigit100
-			TmpDecn.lsu[0] = carry; //was 0 from shift
-		}
-	}
 	//handle last carry
 	if (carry >= 10){
 		//shift
-		shift_right(&TmpDecn);
-		shift_right(&TmpDecn);
+		shift_right_n(&TmpDecn, 2);
 		new_exponent += 1;
 		//add back carry to MSdigit100
-		TmpDecn.lsu[0] = carry; //was 0 from shift
+		TmpDecn.lsu[0] = DIGIT100(carry); //was 0 from shift
 	} else if (carry > 0){
 		//shift
 		shift_right(&TmpDecn);
 		//add back carry to MSdigit in MSdigit100
-		TmpDecn.lsu[0] += carry*10;
+		TmpDecn.lsu[0] += DIGIT100(carry*10);
+	} else {
+		//the product of normalized significands is at least 1, unless one was 0
+		set_dec80_zero(&AccDecn);
+		return;
 	}
 	//set new exponent, checking for over/underflow
 #ifdef DEBUG_MULT
@@ -829,16 +1141,61 @@ void mult_decn(void){
 		set_dec80_NaN(&AccDecn);
 		return;
 	}
-	//copy back to acc
-	copy_decn(&AccDecn, &TmpDecn);
-	//normalize
-	remove_leading_zeros(&AccDecn);
+	//copy back to acc (already normalized)
+	copy_reg(&AccDecn, &TmpDecn);
+}
+
+//AccDecn *= BDecn
+// (the BDecn register is preserved)
+void mult_decn(void){
+#ifdef DEBUG_MULT
+	int8_t j;
+#endif
+	uint8_t carry;
+#ifdef EXTRA_CHECKS
+	if (decn_is_nan(&AccDecn) || decn_is_nan(&BDecn)) {
+		set_dec80_NaN(&AccDecn);
+		return;
+	}
+#endif
+	assert_normalized(&AccDecn);
+	assert_normalized(&BDecn);
+	//do multiply
+	carry = mult_columns(TmpDecn.lsu, DecnNumLsu);
+	zero_remaining_dec80(&TmpDecn, DecnNumLsu);
+#ifdef DEBUG_MULT
+	printf("\n  TmpDecn:");
+	for (j = 0; j < DEC80_NUM_LSU; j++){
+		printf(" %3d", DIGIT100_VAL(TmpDecn.lsu[j]));
+	}
+	printf("\ncarry:%d", carry);
+#endif
+	mult_finish(&AccDecn, &BDecn, carry);
 }
 
+#ifdef DECN_RECIP_NEWTON
+//initial estimates for 1/x, indexed by the most significant digit100 of x (10 to 99)
+// (significand of the estimate, for exponent -exponent(x) - 1)
+// generated by src/decn/proto/recip_seed.py, max relative error 5%
+static const uint8_t RECIP_EST[90] = {
+	95, 87, 80, 74, 69, 65, 61, 57, 54, 51,
+	49, 47, 44, 43, 41, 39, 38, 36, 35, 34,
+	33, 32, 31, 30, 29, 28, 27, 27, 26, 25,
+	25, 24, 24, 23, 22, 22, 22, 21, 21, 20,
+	20, 19, 19, 19, 18, 18, 18, 17, 17, 17,
+	17, 16, 16, 16, 16, 15, 15, 15, 15, 14,
+	14, 14, 14, 14, 13, 13, 13, 13, 13, 13,
+	12, 12, 12, 12, 12, 12, 12, 11, 11, 11,
+	11, 11, 11, 11, 11, 10, 10, 10, 10, 10,
+};
+//5% -> 2.5e-3 -> 6e-6 -> 4e-11 -> 2e-21
+#define RECIP_MAX_ITERATIONS 5
+
 void recip_decn(void){
 #define CURR_RECIP Tmp2Decn //copy of x, holds current 1/x estimate
 	uint8_t i;
 	exp_t initial_exp;
+	exp_t err_exp; //exponent of (1 - recip*x)
 	//check divide by zero
 #ifdef EXTRA_CHECKS
 	if (decn_is_zero(&AccDecn)){
@@ -849,8 +1206,7 @@ void recip_decn(void){
 		return;
 	}
 #endif
-	//normalize
-	remove_leading_zeros(&AccDecn);
+	assert_normalized(&AccDecn);
 	//store copy of x
 	st_push_decn(&AccDecn);
 	//get initial exponent of estimate for 1/x
@@ -864,249 +1220,741 @@ void recip_decn(void){
 	printf(" -> %d\n", initial_exp);
 #endif
 	set_exponent(&CURR_RECIP, initial_exp, (AccDecn.exponent < 0)); //set exponent, copy sign
-	//get initial estimate for 1/x
-	if        (AccDecn.lsu[0] < 20){       //mantissa between 1 and 2
-		      CURR_RECIP.lsu[0] = 50; //0.50 with implicit point and exponent
-	} else if (AccDecn.lsu[0] < 33){
-		      CURR_RECIP.lsu[0] = 30;
-	} else if (AccDecn.lsu[0] < 50){
-		      CURR_RECIP.lsu[0] = 20;
-	} else {
-		      CURR_RECIP.lsu[0] = 10; //0.1 with implicit point and exponent
-	}
+	//get initial estimate for 1/x from the most significant digit100
+	i = DIGIT100_VAL(AccDecn.lsu[0]);
+	CURR_RECIP.lsu[0] = DIGIT100(RECIP_EST[i - 10]);
 	zero_remaining_dec80(&CURR_RECIP, 1);
-	copy_decn(&AccDecn, &CURR_RECIP);
+	copy_reg(&AccDecn, &CURR_RECIP);
 	//do newton-raphson iterations
-	for (i = 0; i < 6; i++){ //just fix number of iterations for now
+#ifdef DESKTOP
+	RecipIterations = 0;
+#endif
+	for (i = 0; i < RECIP_MAX_ITERATIONS; i++){
 #ifdef DEBUG_DIV
 		decn_to_str_complete(&CURR_RECIP);
 		printf("%2d: %s\n", i, Buf);
 #endif
-		//Accum *= x_copy
-		st_load_decn(&BDecn);
-		mult_decn();
-#ifdef DEBUG_DIV
-		decn_to_str_complete(&AccDecn);
-		printf("  %20s: %s\n", "recip*x", Buf);
+#ifdef DESKTOP
+		RecipIterations++;
 #endif
-		//Accum *= -1
+		//Accum = 1 - recip*x
 		negate_decn(&AccDecn);
-		//Accum += 1
-		set_decn_one(&BDecn);
-		add_decn();
+		st_load_decn(&BDecn);
+		fma_decn(&DECN_ONE);
 #ifdef DEBUG_DIV
 		decn_to_str_complete(&AccDecn);
 		printf("  %20s: %s\n", "(1-recip*x)", Buf);
 #endif
-		//Accum *= curr_recip
-		copy_decn(&BDecn, &CURR_RECIP);
+		//check for convergence: the relative error after this iteration is about
+		// (1-recip*x)^2, which is below the last digit if (1-recip*x) < 10^-9
+		// (or below the working precision of DecnNumLsu digit100s)
+		if (decn_is_zero(&AccDecn)){
+			err_exp = DEC80_MIN_EXP;
+		} else {
+			err_exp = get_exponent(&AccDecn);
+		}
+		//new_est(Accum) = recip + (1 - recip*x)*recip, where recip is current recip estimate
+		// (the correction is small, so the product doesn't need the guard digits of fma_decn())
+		copy_reg(&BDecn, &CURR_RECIP);
 		mult_decn();
-#ifdef DEBUG_DIV
-		decn_to_str_complete(&AccDecn);
-		printf("  %20s: %s\n", "recip * (1-recip*x)", Buf);
-#endif
-		//Accum += curr_recip
+		copy_reg(&BDecn, &CURR_RECIP);
 		add_decn();
-		//new_est(Accum) = recip + (1 - recip*x)*recip, where recip is current recip estimate
-		copy_decn(&CURR_RECIP, &AccDecn);
+		copy_reg(&CURR_RECIP, &AccDecn);
+		if (err_exp < -DecnNumLsu){
+			break;
+		}
 	}
 	st_pop_decn(0);
 
 //try not to pollute namespace
 #undef CURR_RECIP
 }
+#else
+//AccDecn = 1/AccDecn, by long division (see div_decn())
+// (the BDecn register is not preserved)
+void recip_decn(void){
+	copy_reg(&BDecn, &AccDecn);
+	set_decn_one(&AccDecn);
+	div_decn();
+}
+#endif //DECN_RECIP_NEWTON
+
+#ifdef DECN_PACKED_BCD
+#define DIVISOR TmpDecn //10's complement of BDecn, for subtraction by addition
+
+static void load_divisor(void){
+	uint8_t i;
+	for (i = 0; i < DEC80_NUM_LSU; i++){
+		DIVISOR.lsu[i] = 0x99 - BDecn.lsu[i];
+	}
+}
+#else
+#define DIVISOR BDecn
+#define load_divisor()
+#endif
+
+//returns 1 if the significand remainder (AccDecn, with rem_high above AccDecn.lsu[0])
+// is at least the divisor significand (BDecn)
+static uint8_t div_rem_ge(uint8_t rem_high){
+	uint8_t i;
+	if (rem_high){
+		return 1;
+	}
+	for (i = 0; i < DEC80_NUM_LSU; i++){
+		if (AccDecn.lsu[i] != BDecn.lsu[i]){
+			return (AccDecn.lsu[i] > BDecn.lsu[i]);
+		}
+	}
+	return 1; //equal
+}
+
+//subtract the divisor significand from the remainder as many times as possible
+// returns the number of subtractions (the next quotient digit)
+// (load_divisor() must have been called)
+static uint8_t div_reduce(uint8_t rem_high){
+	uint8_t count;
+	for (count = 0; div_rem_ge(rem_high); count++){
+		rem_high -= sub_digit100s(&DIVISOR);
+	}
+	return count;
+}
+
+//remainder = (remainder * 10) mod divisor significand
+// (remainder must be less than the divisor significand)
+static void rem_mult10(void){
+	uint8_t rem_high = DIGIT100_HI(AccDecn.lsu[0]);
+	shift_left(&AccDecn);
+	div_reduce(rem_high);
+}
+
+//digit by digit results (quotients and square roots) are built in Tmp2Decn
+#define DIGITS_RESULT Tmp2Decn
+
+//set decimal digit digit_i of the result
+static void set_result_digit(uint8_t digit_i, uint8_t digit){
+	if (digit_i & 1){
+		DIGITS_RESULT.lsu[digit_i / 2] = DIGIT100_MAKE(DIGIT100_HI(DIGITS_RESULT.lsu[digit_i / 2]), digit);
+	} else {
+		DIGITS_RESULT.lsu[digit_i / 2] = DIGIT100_MAKE(digit, 0);
+	}
+}
+
+//round the 18 digit result half up, with the 19th digit
+// (at reduced working precision, the result is truncated after 2*DecnNumLsu digits)
+static void round_result(uint8_t digit){
+	int8_t i;
+	zero_remaining_dec80(&DIGITS_RESULT, DecnNumLsu);
+	//(the result can't round up from 9.99...9 to 10)
+	if (digit >= 5 && DecnNumLsu == DEC80_NUM_LSU){
+		for (i = DEC80_NUM_LSU - 1; DIGITS_RESULT.lsu[i] == DIGIT100(99); i--){
+			DIGITS_RESULT.lsu[i] = 0;
+		}
+		assert(i >= 0);
+		digit = DIGIT100_VAL(DIGITS_RESULT.lsu[i]) + 1;
+		DIGITS_RESULT.lsu[i] = DIGIT100(digit);
+	}
+}
 
+//AccDecn /= BDecn
+// (the BDecn register is preserved)
+//restoring long division directly on the digit100s, one decimal digit at a time
+// (like the HP-35): each quotient digit is the number of times the divisor
+// can be subtracted from the remainder, then the remainder is shifted left.
+// The 19th digit is used to round the 18 digit quotient.
+// (at reduced working precision, the quotient is truncated after 2*DecnNumLsu digits)
 void div_decn(void){
-	//store copy of acc for final multiply by 1/x
-	st_push_decn(&AccDecn);
-	copy_decn(&AccDecn, &BDecn);
-	recip_decn();
-	//Accum now holds 1/x, multiply by original acc to complete division
-	st_pop_decn(&BDecn);
-	mult_decn();
+#define QUOTIENT DIGITS_RESULT
+	uint8_t digit_i, digit;
+	uint8_t rem_high = 0; //decimal digit of remainder above AccDecn.lsu[0]
+	uint8_t is_neg;
+	exp_t new_exponent;
+#ifdef EXTRA_CHECKS
+	if (decn_is_nan(&AccDecn) || decn_is_nan(&BDecn)) {
+		set_dec80_NaN(&AccDecn);
+		return;
+	}
+	//check divide by zero
+	if (decn_is_zero(&BDecn)){
+		set_dec80_NaN(&AccDecn);
+#ifdef DESKTOP
+		printf("error division by 0\n");
+#endif
+		return;
+	}
+#endif
+	if (decn_is_zero(&AccDecn)){
+		return;
+	}
+	assert_normalized(&AccDecn);
+	assert_normalized(&BDecn);
+	//store new sign
+	is_neg = ((AccDecn.exponent < 0) != (BDecn.exponent < 0));
+	//calculate new exponent
+	new_exponent = get_exponent(&AccDecn) - get_exponent(&BDecn);
+	load_divisor();
+	//first quotient digit would be 0 if significand of acc < significand of b
+	if (!div_rem_ge(0)){
+		rem_high = DIGIT100_HI(AccDecn.lsu[0]);
+		shift_left(&AccDecn);
+		new_exponent--;
+	}
+	//long division, AccDecn holds the remainder
+	for (digit_i = 0; ; digit_i++){
+		//remainder < 10 * divisor, so digit <= 9
+		digit = div_reduce(rem_high);
+		if (digit_i == DecnNumLsu * 2){
+			break; //digit is the rounding digit
+		}
+		set_result_digit(digit_i, digit);
+		//remainder *= 10
+		rem_high = DIGIT100_HI(AccDecn.lsu[0]);
+		shift_left(&AccDecn);
+#ifdef DEBUG_DIV
+		printf("%2d: digit %d, rem_high %d\n", digit_i, digit, rem_high);
+#endif
+	}
+	//(with 18 digit operands, the quotient can't round up from 9.99...9 to 10)
+	round_result(digit);
+	//set new exponent, checking for over/underflow
+	if (new_exponent < DEC80_MAX_EXP && new_exponent > DEC80_MIN_EXP){
+		set_exponent(&QUOTIENT, new_exponent, is_neg);
+	} else {
+		set_dec80_NaN(&AccDecn);
+		return;
+	}
+	copy_reg(&AccDecn, &QUOTIENT);
+
+//try not to pollute namespace
+#undef QUOTIENT
 }
 
+#ifdef DECN_FMOD_SQUARING
+//AccDecn = (x * y) mod divisor significand, treating the digit100s as 18 digit integers
+// x must be less than the divisor significand (load_divisor() must have been called)
+//Horner's method on the digits of y, so that no double length product is needed
+static void rem_mult(__idata const dec80* x, __idata const dec80* y){
+	uint8_t digit_i, digit;
+	set_dec80_zero(&AccDecn);
+	for (digit_i = 0; digit_i < DEC80_NUM_LSU * 2; digit_i++){
+		rem_mult10();
+		if (digit_i & 1){
+			digit = DIGIT100_LO(y->lsu[digit_i / 2]);
+		} else {
+			digit = DIGIT100_HI(y->lsu[digit_i / 2]);
+		}
+		//remainder += x * digit: remainder + x < 2 * divisor, so at most 1 subtraction each
+		for ( ; digit > 0; digit--){
+			div_reduce(add_digit100s(&AccDecn, x, 0));
+		}
+	}
+}
+#endif
+
+//AccDecn = remainder of AccDecn / BDecn, with the same sign as AccDecn (like C's fmod())
+// (the BDecn register is preserved)
+//exact: with integer significands a and b, and exponent difference d, the remainder is
+// (a * 10^d) mod b. 10^d mod b is calculated by squaring, so that huge exponent
+// differences take O(log(d)) long divisions instead of d long division steps.
+// (only if DECN_FMOD_SQUARING, otherwise all d digits are shifted in)
+#define FMOD_MAX_SHIFTS 64 //use squaring for larger exponent differences
+void fmod_decn(void){
+#define REM Tmp2Decn
+#define POW10 Tmp3Decn //10^d mod b
+	uint8_t is_neg;
+#ifdef DECN_FMOD_SQUARING
+	uint16_t mask;
+#endif
+	exp_t exp_diff;
+#ifdef EXTRA_CHECKS
+	if (decn_is_nan(&AccDecn) || decn_is_nan(&BDecn)) {
+		set_dec80_NaN(&AccDecn);
+		return;
+	}
+#endif
+	if (decn_is_zero(&BDecn)){
+		set_dec80_NaN(&AccDecn);
+		return;
+	}
+	if (decn_is_zero(&AccDecn)){
+		return;
+	}
+	assert_normalized(&AccDecn);
+	assert_normalized(&BDecn);
+	is_neg = (AccDecn.exponent < 0);
+	exp_diff = get_exponent(&AccDecn) - get_exponent(&BDecn);
+	if (exp_diff < 0){
+		return; //|AccDecn| < |BDecn|
+	}
+	load_divisor();
+	//remainder = a mod b (a < 10 * b)
+	div_reduce(0);
+#ifdef DECN_FMOD_SQUARING
+	if (exp_diff >= FMOD_MAX_SHIFTS){
+		copy_reg(&REM, &AccDecn);
+		//10^d mod b, starting from the most significant bit of d
+		set_dec80_zero(&POW10);
+		POW10.lsu[DEC80_NUM_LSU - 1] = DIGIT100(1);
+		for (mask = 0x4000; mask != 0; mask >>= 1){
+			if ((uint16_t) exp_diff >= (mask << 1)){ //past most significant set bit
+				rem_mult(&POW10, &POW10);
+				copy_reg(&POW10, &AccDecn);
+			}
+			if (exp_diff & mask){
+				copy_reg(&AccDecn, &POW10);
+				rem_mult10();
+				copy_reg(&POW10, &AccDecn);
+			}
+		}
+		rem_mult(&REM, &POW10);
+	} else
+#endif
+	{
+		//shift in the d remaining zero digits directly
+		for ( ; exp_diff > 0; exp_diff--){
+			rem_mult10();
+		}
+	}
+	//remainder has the same scale as b
+	if (decn_is_zero(&AccDecn)){
+		set_dec80_zero(&AccDecn);
+		return;
+	}
+	set_exponent(&AccDecn, get_exponent(&BDecn), is_neg);
+	remove_leading_zeros(&AccDecn);
+	//check for underflow
+	if (get_exponent(&AccDecn) > get_exponent(&BDecn)){
+		set_dec80_NaN(&AccDecn);
+	}
 
+//try not to pollute namespace
+#undef REM
+#undef POW10
+}
+#undef DIVISOR
+
+
+
+//constants used for ln(x), exp(x), and the trig functions, as fixed point (generated by src/decn/proto/constants.cpp)
+// ln(1 + 10^-j), truncated to 21 decimal places
+static const decn_fixed LN_A_ARR[DECN_NUM_LN_A_ARR] = {
+	DECN_FIXED_LSU( 6, 93, 14, 71, 80, 55, 99, 45, 30, 94, 17),
+	DECN_FIXED_LSU( 0, 95, 31,  1, 79, 80, 43, 24, 86,  0, 43),
+	DECN_FIXED_LSU( 0,  9, 95,  3, 30, 85, 31, 68,  8, 28, 48),
+	DECN_FIXED_LSU( 0,  0, 99, 95,  0, 33, 30, 83, 53, 31, 66),
+	DECN_FIXED_LSU( 0,  0,  9, 99, 95,  0,  3, 33, 30, 83, 35),
+	DECN_FIXED_LSU( 0,  0,  0, 99, 99, 95,  0,  0, 33, 33, 30),
+	DECN_FIXED_LSU( 0,  0,  0,  9, 99, 99, 95,  0,  0,  3, 33),
+	DECN_FIXED_LSU( 0,  0,  0,  0, 99, 99, 99, 95,  0,  0,  0),
+	DECN_FIXED_LSU( 0,  0,  0,  0,  9, 99, 99, 99, 95,  0,  0),
+	DECN_FIXED_LSU( 0,  0,  0,  0,  0, 99, 99, 99, 99, 95,  0),
+	DECN_FIXED_LSU( 0,  0,  0,  0,  0,  9, 99, 99, 99, 99, 95),
+};
 
-//constants used for ln(x) and exp(x)
-#define NUM_A_ARR 9
-static const dec80 LN_A_ARR[NUM_A_ARR] = {
-	{-1 & 0x7fff, {69, 31, 47, 18,  5, 59, 94, 53,  9}},
-	{-2 & 0x7fff, {95, 31,  1, 79, 80, 43, 24, 86,  0}},
-	{-3 & 0x7fff, {99, 50, 33,  8, 53, 16, 80, 82, 84}},
-	{-4 & 0x7fff, {99, 95,  0, 33, 30, 83, 53, 31, 67}},
-	{-5 & 0x7fff, {99, 99, 50,  0, 33, 33,  8, 33, 33}},
-	{-6 & 0x7fff, {99, 99, 95,  0,  0, 33, 33, 29, 95}},
-	{-7 & 0x7fff, {99, 99, 99, 50,  0,  0, 33,  5, 35}},
-	{-8 & 0x7fff, {99, 99, 99, 95,  0,  0,  2, 76, 40}},
-	{-9 & 0x7fff, {99, 99, 99, 99, 50,  0, 15, 98, 65}},
+// atan(10^-j), truncated to 21 decimal places
+static const decn_fixed ATAN_A_ARR[DECN_NUM_ATAN_A_ARR] = {
+	DECN_FIXED_LSU( 7, 85, 39, 81, 63, 39, 74, 48, 30, 96, 15),
+	DECN_FIXED_LSU( 0, 99, 66, 86, 52, 49, 11, 62,  2, 73, 78),
+	DECN_FIXED_LSU( 0,  9, 99, 96, 66, 68, 66, 65, 23, 82,  6),
+	DECN_FIXED_LSU( 0,  0, 99, 99, 99, 66, 66, 66, 86, 66, 66),
+	DECN_FIXED_LSU( 0,  0,  9, 99, 99, 99, 96, 66, 66, 66, 68),
+	DECN_FIXED_LSU( 0,  0,  0, 99, 99, 99, 99, 99, 66, 66, 66),
+	DECN_FIXED_LSU( 0,  0,  0,  9, 99, 99, 99, 99, 99, 96, 66),
+	DECN_FIXED_LSU( 0,  0,  0,  0, 99, 99, 99, 99, 99, 99, 99),
+	DECN_FIXED_LSU( 0,  0,  0,  0,  9, 99, 99, 99, 99, 99, 99),
 };
 
+#ifdef DECN_LN_NEAR_1
+// ln(10), truncated to 21 decimal places
+static const decn_fixed LN_10_FIXED = DECN_FIXED_LSU(23,  2, 58, 50, 92, 99, 40, 45, 68, 40, 17);
+#endif
+
+//fixed point primitives for the ln(x) and exp(x) pseudo-division/pseudo-multiplication
+// (also used as 22 digit integers by sqrt(x))
+// (values always stay between 0 and 10, so there's no need to normalize or track
+//  exponents and signs, as add_decn() does)
+
+static const decn_fixed FIXED_ZERO = DECN_FIXED_LSU(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+//dst = a + (x shifted right by n digits), returns carry out (sum >= 10)
+// dst can be the same as a and/or x: each digit100 only depends on digit100s of x
+// that are at the same or a more significant position
+static uint8_t fixed_add_shifted(decn_fixed* dst, const decn_fixed* a, const decn_fixed* x, uint8_t n){
+	int8_t i;
+	int8_t x_i = DECN_FIXED_NUM_LSU - 1 - n / 2; //digit100 of x at position i after shift
+	uint8_t carry = 0;
+	for (i = DECN_FIXED_NUM_LSU - 1; i >= 0; i--, x_i--){
+		uint8_t digit100 = DIGIT100_VAL(a->lsu[i]) + carry;
+		if (x_i >= 0){
+			if (n & 1){
+				digit100 += DIGIT100_HI(x->lsu[x_i]);
+				if (x_i > 0){
+					digit100 += DIGIT100_LO(x->lsu[x_i - 1]) * 10;
+				}
+			} else {
+				digit100 += DIGIT100_VAL(x->lsu[x_i]);
+			}
+		}
+		carry = 0;
+		if (digit100 >= 100){
+			digit100 -= 100;
+			carry = 1;
+		}
+		dst->lsu[i] = DIGIT100(digit100);
+	}
+	return carry;
+}
+
+//x *= 10 (x must be < 1)
+static void fixed_shift_left(decn_fixed* x){
+	uint8_t shift_high, shift_old = 0;
+	int8_t i;
+	for (i = DECN_FIXED_NUM_LSU - 1; i >= 0; i--){
+		shift_high = DIGIT100_HI(x->lsu[i]);
+		x->lsu[i] = DIGIT100_MAKE(DIGIT100_LO(x->lsu[i]), shift_old);
+		shift_old = shift_high;
+	}
+}
+
+//x += 2 in the last digit (x must be < 10 - 2*10^-21)
+static void fixed_add2(decn_fixed* x){
+	int8_t i = DECN_FIXED_NUM_LSU - 1;
+	uint8_t digit100 = DIGIT100_VAL(x->lsu[i]) + 2;
+	while (digit100 >= 100){ //carry
+		x->lsu[i] = DIGIT100(digit100 - 100);
+		i--;
+		digit100 = DIGIT100_VAL(x->lsu[i]) + 1;
+	}
+	x->lsu[i] = DIGIT100(digit100);
+}
+
+//acc -= x, returns borrow out (difference < 0)
+static uint8_t fixed_sub(decn_fixed* acc, const decn_fixed* x){
+	int8_t i;
+	uint8_t borrow = 0;
+	for (i = DECN_FIXED_NUM_LSU - 1; i >= 0; i--){
+		uint8_t digit100 = DIGIT100_VAL(acc->lsu[i]);
+		uint8_t sub = DIGIT100_VAL(x->lsu[i]) + borrow;
+		borrow = 0;
+		if (digit100 < sub){
+			digit100 += 100;
+			borrow = 1;
+		}
+		acc->lsu[i] = DIGIT100(digit100 - sub);
+	}
+	return borrow;
+}
+
+//x >>= n digits
+static void fixed_shift_right(decn_fixed* x, exp_t n){
+	if (n > 2 * DECN_FIXED_NUM_LSU){
+		n = 2 * DECN_FIXED_NUM_LSU; //shifted out completely
+	}
+	fixed_add_shifted(x, &FIXED_ZERO, x, n);
+}
+
+//dst = x, x must be non-negative and < 10
+static void decn_to_fixed(decn_fixed* dst, const dec80* x){
+	exp_t exponent;
+	uint8_t i;
+	assert_normalized(x);
+	exponent = get_exponent(x);
+	assert(exponent <= 0 || decn_is_zero(x));
+	for (i = 0; i < DECN_FIXED_NUM_LSU; i++){
+		dst->lsu[i] = (i < DEC80_NUM_LSU) ? x->lsu[i] : 0;
+	}
+	if (exponent < 0){
+		fixed_shift_right(dst, -exponent);
+	}
+}
+
+//dst = x, keeping as many of the guard digits as possible
+static void fixed_to_decn(__idata dec80* dst, const decn_fixed* x){
+	uint8_t i, j;
+	exp_t exponent;
+	//skip leading zero digit100s
+	for (i = 0; i < DECN_FIXED_NUM_LSU - 1 && x->lsu[i] == 0; i++){
+	}
+	exponent = -2 * i;
+	for (j = 0; j < DEC80_NUM_LSU; j++, i++){
+		dst->lsu[j] = (i < DECN_FIXED_NUM_LSU) ? x->lsu[i] : 0;
+	}
+	//shift in the next guard digit if the most significant digit is 0
+	if (DIGIT100_HI(dst->lsu[0]) == 0 && i < DECN_FIXED_NUM_LSU){
+		shift_left(dst);
+		dst->lsu[DEC80_NUM_LSU - 1] += DIGIT100_HI(x->lsu[i]);
+		exponent--;
+	}
+	set_exponent(dst, exponent, 0);
+	remove_leading_zeros(dst);
+}
+
+#ifdef DECN_FMA
+//AccDecn = AccDecn * BDecn + c, truncated only once at the end
+// (the BDecn register is preserved)
+//the product is kept to 22 digits in the fixed point registers, and c is added to it
+// aligned there, so that digits aren't lost when the product and c (nearly) cancel
+void fma_decn(const dec80* c){
+	uint8_t i, is_neg, c_is_neg;
+	exp_t sum_exp, c_exp;
+	decn_fixed* sum = &FixedDecn;
+#ifdef EXTRA_CHECKS
+	if (decn_is_nan(&AccDecn) || decn_is_nan(&BDecn) || decn_is_nan(c)) {
+		set_dec80_NaN(&AccDecn);
+		return;
+	}
+#endif
+	if (decn_is_zero(&AccDecn) || decn_is_zero(&BDecn)){
+		copy_decn(&AccDecn, c);
+		return;
+	}
+	if (decn_is_zero(c)){
+		mult_decn();
+		return;
+	}
+	assert_normalized(&AccDecn);
+	assert_normalized(&BDecn);
+	assert_normalized(c);
+	is_neg = ((AccDecn.exponent < 0) != (BDecn.exponent < 0));
+	c_is_neg = (c->exponent < 0);
+	//product of significands is between 1 and 100: the carry out is the first digit100
+	sum_exp = get_exponent(&AccDecn) + get_exponent(&BDecn) + 1;
+	FixedDecn.lsu[0] = DIGIT100(mult_columns(&FixedDecn.lsu[1], DECN_FIXED_NUM_LSU - 1));
+	for (i = 0; i < DECN_FIXED_NUM_LSU; i++){
+		Fixed2Decn.lsu[i] = (i < DEC80_NUM_LSU) ? c->lsu[i] : 0;
+	}
+	//align to the larger exponent
+	c_exp = get_exponent(c);
+	if (sum_exp > c_exp){
+		fixed_shift_right(&Fixed2Decn, sum_exp - c_exp);
+	} else if (sum_exp < c_exp){
+		fixed_shift_right(&FixedDecn, c_exp - sum_exp);
+		sum_exp = c_exp;
+	}
+	if (is_neg == c_is_neg){
+		if (fixed_add_shifted(&FixedDecn, &FixedDecn, &Fixed2Decn, 0)){
+			//sum >= 10, shift in carry
+			fixed_shift_right(&FixedDecn, 1);
+			FixedDecn.lsu[0] += DIGIT100(10);
+			sum_exp++;
+		}
+	} else {
+		//subtract the smaller magnitude from the larger one
+		for (i = 0; i < DECN_FIXED_NUM_LSU - 1 && FixedDecn.lsu[i] == Fixed2Decn.lsu[i]; i++){
+		}
+		if (DIGIT100_VAL(FixedDecn.lsu[i]) >= DIGIT100_VAL(Fixed2Decn.lsu[i])){
+			fixed_sub(&FixedDecn, &Fixed2Decn);
+		} else {
+			fixed_sub(&Fixed2Decn, &FixedDecn);
+			sum = &Fixed2Decn;
+			is_neg = c_is_neg;
+		}
+	}
+	fixed_to_decn(&AccDecn, sum);
+	if (decn_is_zero(&AccDecn)){
+		set_dec80_zero(&AccDecn);
+		return;
+	}
+	//set new exponent, checking for over/underflow
+	sum_exp += get_exponent(&AccDecn);
+	if (sum_exp < DEC80_MAX_EXP && sum_exp > DEC80_MIN_EXP){
+		set_exponent(&AccDecn, sum_exp, is_neg);
+	} else {
+		set_dec80_NaN(&AccDecn);
+	}
+}
+#else
+//AccDecn = AccDecn * BDecn + c, the product is truncated before adding c
+// (the BDecn register is preserved)
+void fma_decn(const dec80* c){
+	st_push_decn(&BDecn);
+	mult_decn();
+	copy_decn(&BDecn, c);
+	add_decn();
+	st_pop_decn(&BDecn);
+}
+#endif //DECN_FMA
+
+//x = n exactly
+static void exponent_to_decn(__idata dec80* x, exp_t n){
+	uint8_t is_neg = (n < 0);
+	uint16_t u = is_neg ? -n : n;
+	int8_t i;
+	//|n| as an integer in the last digit100s, then normalized
+	set_dec80_zero(x);
+	for (i = DEC80_NUM_LSU - 1; u != 0; i--){
+		x->lsu[i] = DIGIT100(u % 100);
+		u /= 100;
+	}
+	x->exponent = DEC80_NUM_LSU * 2 - 1;
+	remove_leading_zeros(x);
+	if (is_neg){
+		negate_decn(x);
+	}
+}
+
+//number of ln(1 + 10^-j) constants used by ln_decn() and exp_decn() at the working
+// precision: the remainder r after them is below 10^-(num - 1), and ln(1 + r) ~= r
+// and exp(r) ~= 1 + r are accurate to about r^2/2
+static uint8_t ln_num_terms(void){
+	uint8_t num = DecnNumLsu + 2;
+	return (num < DECN_NUM_LN_A_ARR) ? num : DECN_NUM_LN_A_ARR;
+}
+
 void ln_decn(void){
 	uint8_t j, k;
-#define B_j Tmp2Decn
-#define NUM_TIMES Tmp3Decn
+	uint8_t num_terms = ln_num_terms();
+	exp_t initial_exp;
+	decn_fixed* y = &FixedDecn;
+	decn_fixed* next_y = &Fixed2Decn;
+#define SAVED Tmp2Decn
 
 	//check not negative or zero
 	if (AccDecn.exponent < 0 || decn_is_zero(&AccDecn)){
 		set_dec80_NaN(&AccDecn);
 		return;
 	}
-	//normalize
-	remove_leading_zeros(&AccDecn);
-	//scale to between 1 and 10
-	NUM_TIMES.exponent = get_exponent(&AccDecn) + 1; //store initial exp in NUM_TIMES.exponent
+	assert_normalized(&AccDecn);
+	//scale to between 1 and 10:
+	// ln(x) = ln(A * 10^exp) = (exp + 1)*ln(10) - ln(10/A)
+	initial_exp = get_exponent(&AccDecn) + 1;
 	AccDecn.exponent = 0;
 #ifdef DEBUG_LOG
 	decn_to_str_complete(&AccDecn);
 	printf("ln() accum scaled between 1,10: %s\n", Buf);
 #endif
-	//get initial estimate (accum = 10 - A)
-	set_decn_one(&BDecn);
-	BDecn.exponent = 1; //BDecn = 10
-	negate_decn(&AccDecn);
-	add_decn();
-	copy_decn(&B_j, &AccDecn); //b_j = accum = 10 - A
-#ifdef DEBUG_LOG
-	decn_to_str_complete(&AccDecn);
-	printf("ln() initial accum: %s (%d)\n", Buf, NUM_TIMES.exponent);
-#endif
-
-	//track number of times multiplied by a_arr[j]
-	for (j = 0; j < NUM_A_ARR; j++){
-		uint8_t k_j;
-		if (j != 0){
-			//b_j *= 10.0
-			shift_left(&B_j);
-		}
-		copy_decn(&AccDecn, &B_j); //accum = b_j
-		k_j = 0;
-		while (!(AccDecn.exponent < 0)){ //while >= 0 (!negative) TODO: should just be >
-			uint8_t i;
-			copy_decn(&B_j, &AccDecn); //b_j = accum
-			//accum *= a_arr[j]
-			// since a_arr[j] is of the form 1 + 10^-j, just shift accum and add to self
-			copy_decn(&BDecn, &AccDecn);
-			for (i = 0; i < j; i++){
-				shift_right(&BDecn);
-			}
-			add_decn();
-			//accum -= 10
-			// accum.exponent is 1 while needs subtracting
-			if (AccDecn.lsu[0] >= 10 && get_exponent(&AccDecn) > 0){
-				AccDecn.lsu[0] -= 10;
-			} else {
-				//set as negative to get out of while(), accum will get overwritten with b_j
-				AccDecn.exponent = -1;
-			}
-#ifdef DEBUG_LOG_ALL
-			decn_to_str_complete(&AccDecn);
-			printf("    %u: %s\t", k_j, Buf);
-			for (int ii = 0; ii < DEC80_NUM_LSU; ii++){
-				printf("%2d ", AccDecn.lsu[ii]);
-			}
-			printf(" (%d)\n", get_exponent(&AccDecn));
-#endif
-			k_j++;
-#ifdef DEBUG_LOG
-			assert(k_j != 255);
-#endif
+	//ln(1) == 0 exactly
+	if (initial_exp == 1 && AccDecn.lsu[0] == DIGIT100(10)){
+		for (j = 1; j < DEC80_NUM_LSU && AccDecn.lsu[j] == 0; j++){
 		}
-		//track num times
-		NUM_TIMES.lsu[j] = k_j - 1;
+		if (j == DEC80_NUM_LSU){
+			set_dec80_zero(&AccDecn);
+			return;
+		}
+	}
+	//pseudo-division: find y = A * prod((1 + 10^-j)^k_j), with y just below 10
+	// (multiplying by (1 + 10^-j) is just a shift and add)
+	decn_to_fixed(y, &AccDecn);
+	for (j = 0; j < num_terms; j++){
+		k = 0;
+		while (!fixed_add_shifted(next_y, y, y, j)){ //while y * (1 + 10^-j) < 10
+			decn_fixed* swap = y;
+			y = next_y;
+			next_y = swap;
+			k++;
+		}
+		NumTimes[j] = k;
 #ifdef DEBUG_LOG
-		decn_to_str_complete(&B_j);
-		printf("  %u: num_times: %u, %s\n", j, NUM_TIMES.lsu[j], Buf);
+		printf("  %u: num_times: %u\n", j, k);
 #endif
 	}
 
-	//build final value
-	copy_decn(&AccDecn, &B_j); //remainder
-#ifdef DEBUG_LOG
-	decn_to_str_complete(&AccDecn);
-	printf("ln() remainder: %s\n", Buf);
-#endif
-	for (j = NUM_A_ARR - 1; j < NUM_A_ARR; j--){ //sum in reverse order, note: (j < NUM_A_ARR) == signed(j >= 0)
-		for (k = 0; k < NUM_TIMES.lsu[j]; k++){
-			//accum += ln_a_arr[j];
-			copy_decn(&BDecn, &LN_A_ARR[j]);
-			BDecn.exponent = 0; //tracking exponent through shifts/saved initial exponent
-			add_decn();
+	//ln(10/A) = sum(k_j * ln(1 + 10^-j)) + ln(10/y)
+	// ln(10/y) ~= (10 - y)/10, since y is within 10^-10 of 10
+	for (j = 0; j < DECN_FIXED_NUM_LSU; j++){
+		next_y->lsu[j] = DIGIT100(99) - y->lsu[j]; //9.99...9 - y
+	}
+	fixed_add_shifted(next_y, &FIXED_ZERO, next_y, 1); //(9.99...9 - y)/10
+	for (j = num_terms - 1; j < DECN_NUM_LN_A_ARR; j--){ //sum in reverse order, note: (j < DECN_NUM_LN_A_ARR) == signed(j >= 0)
+		for (k = 0; k < NumTimes[j]; k++){
+			fixed_add_shifted(next_y, next_y, &LN_A_ARR[j], 0);
 		}
-		shift_right(&AccDecn);
-#ifdef DEBUG_LOG
-		decn_to_str_complete(&AccDecn);
-		printf("%u: ln() remainder: %s\n", j, Buf);
-#endif
 	}
+
+#ifdef DECN_LN_NEAR_1
+	if (initial_exp == 1){
+		//x is between 1 and 10, subtract from ln(10) using fixed point
+		// (the result can be much smaller than ln(10) for x near 1)
+		for (j = 0; j < DECN_FIXED_NUM_LSU; j++){
+			y->lsu[j] = LN_10_FIXED.lsu[j];
+		}
+		if (fixed_sub(y, next_y)){
+			//x within rounding error of 1
+			set_dec80_zero(&AccDecn);
+			return;
+		}
+		fixed_to_decn(&AccDecn, y);
+		return;
+	}
+#endif
+	fixed_to_decn(&AccDecn, next_y);
+	//accum = -accum;
+	negate_decn(&AccDecn);
 #ifdef DEBUG_LOG
 	decn_to_str_complete(&AccDecn);
 	printf("ln() accum after summing: %s\n", Buf);
 #endif
-	//accum = -accum;
-	negate_decn(&AccDecn);
 
-	//add back in initial exponent (stored in NUM_TIMES.exponent)
-	copy_decn(&B_j, &AccDecn); //temporarily store accum in B_j
-	set_dec80_zero(&AccDecn);
-	//check if negative
-	if (NUM_TIMES.exponent < 0){
-		j = 1; //track is_neg
-		NUM_TIMES.exponent = -NUM_TIMES.exponent;
-	} else {
-		j = 0;
-	}
-	//check if too big for single lsu
-#ifdef EXP16
-	if (NUM_TIMES.exponent >= 10000){
-		AccDecn.lsu[0] = NUM_TIMES.exponent / 10000;
-		NUM_TIMES.exponent    = NUM_TIMES.exponent % 10000;
-		AccDecn.lsu[1] = NUM_TIMES.exponent / 100;
-		AccDecn.lsu[2] = NUM_TIMES.exponent % 100;
-		AccDecn.exponent = 5;
-	} else
-#endif
-	if (NUM_TIMES.exponent >= 100){
-		AccDecn.lsu[0] = NUM_TIMES.exponent / 100;
-		AccDecn.lsu[1] = NUM_TIMES.exponent % 100;
-		AccDecn.exponent = 3;
-	} else {
-		AccDecn.lsu[0] = NUM_TIMES.exponent;
-		AccDecn.exponent = 1;
-	}
-	//check if need to negate
-	if (j) { //was negative
-		negate_decn(&AccDecn);
-	}
+	//add back in initial exponent
+	copy_reg(&SAVED, &AccDecn); //temporarily store accum
+	exponent_to_decn(&AccDecn, initial_exp);
 #ifdef DEBUG_LOG
 	decn_to_str_complete(&AccDecn);
 	printf("ln() exponent from initial: %s\n", Buf);
 #endif
-	//initial exp * ln(10)
+	//initial exp * ln(10) + stored accum
 	copy_decn(&BDecn, &DECN_LN_10);
-	mult_decn();
-	//add back stored accum
-	copy_decn(&BDecn, &B_j);
-	add_decn();
+	fma_decn(&SAVED);
 
 //try not to pollute namespace
-#undef B_j
-#undef NUM_TIMES
+#undef SAVED
 }
 
 void log10_decn(void){
+	exp_t exponent;
+	//check not negative or zero
+	if (AccDecn.exponent < 0 || decn_is_zero(&AccDecn)){
+		set_dec80_NaN(&AccDecn);
+		return;
+	}
+	//log10(A * 10^exp) = exp + ln(A) * 1/ln(10), with A between 1 and 10
+	// (the integer part is added exactly, so powers of 10 give exact results)
+	assert_normalized(&AccDecn);
+	exponent = get_exponent(&AccDecn);
+	AccDecn.exponent = 0;
 	ln_decn();
-	copy_decn(&BDecn, &DECN_LN_10);
-	div_decn();
+	exponent_to_decn(&Tmp2Decn, exponent);
+	copy_decn(&BDecn, &DECN_1_LN_10);
+	fma_decn(&Tmp2Decn);
 }
 
 
 
+//truncate x to an integer (rounding towards 0)
+// x must be normalized
+// returns the integer part of |x| if it's less than 10000, otherwise UINT16_MAX
+static uint16_t trunc_decn(dec80* x){
+	exp_t exponent = get_exponent(x);
+	uint16_t int_part = 0;
+	uint8_t i;
+	if (exponent < 0){
+		set_dec80_zero(x);
+		return 0;
+	}
+	//clear fractional digits, while accumulating integer digits
+	for (i = 0; i < DEC80_NUM_LSU; i++){
+		if (2 * i > exponent){
+			x->lsu[i] = 0;
+			continue;
+		}
+		int_part = int_part * 10 + DIGIT100_HI(x->lsu[i]);
+		if (2 * i == exponent){
+			x->lsu[i] = DIGIT100_MAKE(DIGIT100_HI(x->lsu[i]), 0);
+		} else {
+			int_part = int_part * 10 + DIGIT100_LO(x->lsu[i]);
+		}
+	}
+	if (exponent > 3){
+		return UINT16_MAX;
+	}
+	return int_part;
+}
+
 void exp_decn(void){
 	uint8_t j, k;
+	uint8_t num_terms = ln_num_terms();
 	uint8_t need_recip = 0;
+	uint16_t num_ln10; //number of times ln(10) is subtracted
 #define SAVED Tmp2Decn
-#define NUM_TIMES Tmp3Decn
 
 	//check not error
 	if (decn_is_nan(&AccDecn)){
@@ -1119,131 +1967,68 @@ void exp_decn(void){
 		need_recip = 1;
 	}
 
-	//check if in range
-	copy_decn(&SAVED, &AccDecn); //save = accum
-	set_dec80_zero(&BDecn);
-	BDecn.lsu[0] = 29;
-	BDecn.lsu[1] = 47;
-	BDecn.exponent = 2; //b = 294.7
-	negate_decn(&BDecn);
-	add_decn(); //accum = x - 294.7 (should be negative if in range)
-	if (!(AccDecn.exponent < 0)){ //if not negative
+	//range reduction: exp(x) = 10^n * exp(x - n*ln(10))
+	// calculate n = floor(x / ln(10)) in a single step using 1/ln(10)
+	// (truncated 1/ln(10) and ln(10) constants ensure n is never too large, so that
+	//  the remainder never goes negative. n can be one too small though, e.g. for
+	//  x == k*ln(10), which is corrected after calculating the remainder.)
+	copy_reg(&SAVED, &AccDecn); //save = x
+	copy_decn(&BDecn, &DECN_1_LN_10);
+	mult_decn(); //accum = x/ln(10)
+	num_ln10 = trunc_decn(&AccDecn); //accum = n
+	//check if in range: result must be < 10^128
+	if (num_ln10 >= 128){
 		set_dec80_NaN(&AccDecn);
 		return;
 	}
-	copy_decn(&AccDecn, &SAVED); //restore
-
-// 	//normalize
-// 	remove_leading_zeros(&AccDecn);
-
-	//initial b = -10*ln(10)
-	copy_decn(&BDecn, &DECN_LN_10); //b=ln(10)
-	copy_decn(&SAVED, &AccDecn); //save = accum
-	set_decn_one(&AccDecn);
-	AccDecn.exponent = 1; //accum = 10
-	mult_decn();             //accum =  10*ln(10)
-	copy_decn(&BDecn, &AccDecn); //b =  10*ln(10)
-	negate_decn(&BDecn);         //b = -10*ln(10)
-	copy_decn(&AccDecn, &SAVED); //restore
-	//track number of times 10*ln(10) can be subtracted
-	k = 0;
-	while (!(AccDecn.exponent < 0)){ //while not negative
-		copy_decn(&SAVED, &AccDecn); //save = accum
-		//accum -= 10*ln10
-		add_decn();
-		k++;
+	negate_decn(&AccDecn);
+	copy_decn(&BDecn, &DECN_LN_10);
+	fma_decn(&SAVED);        //accum = x - n*ln(10)
+	//remainder >= ln(10): n is one too small, subtract ln(10) once more
+	// (so that e.g. exp10(k) is exactly 10^k)
+	copy_reg(&SAVED, &AccDecn);
+	negate_decn(&BDecn); //BDecn = -ln(10)
+	add_decn();
+	if (AccDecn.exponent < 0){ //remainder < ln(10)
+		copy_reg(&AccDecn, &SAVED);
+	} else if (++num_ln10 >= 128){
+		set_dec80_NaN(&AccDecn);
+		return;
 	}
-	//subtracted 1 time too many
-	NUM_TIMES.exponent = (k - 1) * 10; //use exp to store number of times ln(10) subtracted
-	copy_decn(&AccDecn, &SAVED); //restore
 #ifdef DEBUG_EXP
 	decn_to_str_complete(&AccDecn);
-	printf("exp() num_times for 10*ln(10): %s (%d)\n", Buf, NUM_TIMES.exponent);
+	printf("exp() num_times for ln(10): %s (%d)\n", Buf, num_ln10);
 #endif
 
-	//load b with -ln(10)
-	copy_decn(&BDecn, &DECN_LN_10); //b =  ln(10)
-	negate_decn(&BDecn);            //b = -ln(10)
-	//track number of times ln(10) and then (1 + 10^-j) can be subtracted
-	j = UINT8_MAX; //becomes 0 after incrementing to start (1 + 10^-j) series
-	do {
+	//pseudo-division: track number of times ln(1 + 10^-j) can be subtracted
+	decn_to_fixed(&FixedDecn, &AccDecn);
+	for (j = 0; j < num_terms; j++){
 		k = 0;
-		while (!(AccDecn.exponent < 0)){ //while not negative
-			copy_decn(&SAVED, &AccDecn); //save = accum
-			//accum -= b (ln10, then ln(1 + 10^-j) series)
-			add_decn();
-#ifdef DEBUG_EXP_ALL
-			decn_to_str_complete(&AccDecn);
-			printf("    %u: %s\n", k, Buf);
-// 			decn_to_str_complete(&BDecn);
-// 			printf("(%s)\n", Buf);
-#endif
+		while (!fixed_sub(&FixedDecn, &LN_A_ARR[j])){ //while not negative
 			k++;
-#ifdef DEBUG_EXP
-			assert(k != 255);
-#endif
 		}
-		//subtracted 1 time too many:
-		if (j == UINT8_MAX){
-			NUM_TIMES.exponent += k - 1;
-		} else {
-			NUM_TIMES.lsu[j] = k - 1;
-		}
-		copy_decn(&AccDecn, &SAVED); //restore
+		//subtracted 1 time too many: restore
+		fixed_add_shifted(&FixedDecn, &FixedDecn, &LN_A_ARR[j], 0);
+		NumTimes[j] = k;
 #ifdef DEBUG_EXP
-		decn_to_str_complete(&AccDecn);
-		printf("exp() num_times for %d: %s (%d)\n", j, Buf, k-1);
-#endif
-		//next j
-		j++;
-		if (j < NUM_A_ARR){
-			//get next ln(1 + 10^-j) for subtraction
-			copy_decn(&BDecn, &LN_A_ARR[j]);
-			negate_decn(&BDecn);
-		} else {
-			break;
-		}
-	} while (1);
+		printf("exp() num_times for %d: %d\n", j, k);
+#endif
+	}
 
-	//build final value
-	// (currently accum = save = remainder)
-	// calculate 1+remainder
-	set_decn_one(&BDecn);
-	add_decn();
-	//get initial multiplier (10) for ln(10)
-	set_decn_one(&BDecn);
-	BDecn.exponent = 1; //BDecn = 10
-	//do multiplies
-	j = UINT8_MAX; //becomes 0 after incrementing to start (1 + 10^-j) series
-	do {
-		for (k = 0; k < (j==UINT8_MAX ? NUM_TIMES.exponent : NUM_TIMES.lsu[j]); k++){
-			mult_decn();
-		}
-#ifdef DEBUG_EXP
-		decn_to_str_complete(&AccDecn);
-		printf("exp() current val for %d: %s\n", j, Buf);
-#endif
-		//next j
-		j++;
-		if (j < NUM_A_ARR){
-			//get next multiplier (1 + 10^-j) for ln(1 + 10^-j)
-			if (j == 0){
-				//set to 2
-				BDecn.lsu[0] = 20;
-				BDecn.exponent = 0;
-			} else if (j == 1) {
-				//set to 1.1
-				BDecn.lsu[0] = 11;
-				//exponent is already 0
-			} else {
-				//get next (1 + 10^-j)
-				shift_right(&BDecn);
-				BDecn.lsu[0] = 10;
-			}
-		} else {
-			break;
+	//pseudo-multiplication: exp(remainder) = (1 + r) * prod((1 + 10^-j)^k_j)
+	// (the product is scaled by 1/10, so that it can't overflow for a remainder
+	//  within rounding error of ln(10))
+	FixedDecn.lsu[0] = DIGIT100(10); //1 + r, r < 10^-10
+	fixed_add_shifted(&FixedDecn, &FIXED_ZERO, &FixedDecn, 1);
+	for (j = num_terms - 1; j < DECN_NUM_LN_A_ARR; j--){ //note: (j < DECN_NUM_LN_A_ARR) == signed(j >= 0)
+		for (k = 0; k < NumTimes[j]; k++){
+			//multiply by (1 + 10^-j): just shift and add
+			fixed_add_shifted(&FixedDecn, &FixedDecn, &FixedDecn, j);
 		}
-	} while (1);
+	}
+	fixed_to_decn(&AccDecn, &FixedDecn);
+	//multiply by 10^(n + 1), to undo the scaling
+	set_exponent(&AccDecn, get_exponent(&AccDecn) + num_ln10 + 1, 0);
 
 #ifdef DEBUG_EXP
 	decn_to_str_complete(&AccDecn);
@@ -1261,17 +2046,53 @@ void exp_decn(void){
 
 //try not to pollute namespace
 #undef SAVED
-#undef NUM_TIMES
 }
 
 void exp10_decn(void){
-	//exp10_decn() = exp_decn(AccDecn * ln(10))
+	uint16_t n;
+	const uint8_t is_negative = AccDecn.exponent < 0;
+	if (decn_is_nan(&AccDecn)){
+		return;
+	}
+	//10^x = 10^n * exp((x - n)*ln(10)), where n is the integer part of x
+	// (n is added to the exponent exactly, so that e.g. 10^127 is exact)
+	copy_reg(&Tmp2Decn, &AccDecn);
+	n = trunc_decn(&AccDecn);
+	if (n >= 128){ //result must be < 10^128
+		set_dec80_NaN(&AccDecn);
+		return;
+	}
+	copy_reg(&BDecn, &AccDecn);
+	negate_decn(&BDecn);
+	copy_reg(&AccDecn, &Tmp2Decn);
+	add_decn(); //fractional part
 	copy_decn(&BDecn, &DECN_LN_10);
 	mult_decn();
 	exp_decn();
+	set_exponent(&AccDecn, get_exponent(&AccDecn) + (is_negative ? -(exp_t) n : (exp_t) n), 0);
+}
+
+//integer exponents below this are calculated by repeated multiplication
+// (each multiplication truncates, so the error grows with the exponent)
+#define POW_MAX_INT_EXP 128 //must be a power of 2
+
+//returns 1 if the integer x is odd (x must be normalized)
+static uint8_t int_decn_is_odd(const dec80* x){
+	exp_t exponent = get_exponent(x);
+	if (exponent >= DEC80_NUM_LSU * 2){
+		return 0; //multiple of 10
+	}
+	if (exponent & 1){
+		return DIGIT100_LO(x->lsu[exponent / 2]) & 1;
+	}
+	return DIGIT100_HI(x->lsu[exponent / 2]) & 1;
 }
 
 void pow_decn(void) {
+#define BASE Tmp2Decn
+	uint16_t n, mask;
+	uint8_t i;
+	uint8_t negate_result = 0;
 	if (decn_is_zero(&BDecn)) {
 		set_decn_one(&AccDecn);
 		return;
@@ -1280,12 +2101,56 @@ void pow_decn(void) {
 		set_dec80_zero(&AccDecn);
 		return;
 	}
-	//calculate AccDecn = AccDecn ^ BDecn
+	//check for an integer exponent
+	assert_normalized(&BDecn);
+	copy_reg(&TmpDecn, &BDecn);
+	n = trunc_decn(&TmpDecn);
+	for (i = 0; i < DEC80_NUM_LSU; i++){
+		if (TmpDecn.lsu[i] != BDecn.lsu[i]){
+			break;
+		}
+	}
 	st_push_decn(&BDecn);
+	if (i == DEC80_NUM_LSU && n < POW_MAX_INT_EXP){
+		//binary exponentiation (left to right), exact if representable
+		copy_reg(&BASE, &AccDecn);
+		for (mask = POW_MAX_INT_EXP / 2; !(n & mask); mask >>= 1){
+			;
+		}
+		for (mask >>= 1; mask != 0; mask >>= 1){
+			copy_reg(&BDecn, &AccDecn);
+			mult_decn();
+			if (n & mask){
+				copy_reg(&BDecn, &BASE);
+				mult_decn();
+			}
+		}
+		//x^-n == 1/(x^n)
+		st_load_decn(&BDecn);
+		if (BDecn.exponent < 0){
+			copy_reg(&BDecn, &AccDecn);
+			set_decn_one(&AccDecn);
+			div_decn();
+		}
+		st_pop_decn(&BDecn);
+		return;
+	}
+	//negative number raised to an integer power: (-x)^n == (+/-)x^n
+	if (i == DEC80_NUM_LSU && AccDecn.exponent < 0){
+		negate_decn(&AccDecn);
+		negate_result = int_decn_is_odd(&BDecn);
+	}
+	//calculate AccDecn = AccDecn ^ BDecn
 	ln_decn();
 	st_pop_decn(&BDecn);
 	mult_decn(); //accum = b*ln(accum)
 	exp_decn();
+	if (negate_result){
+		negate_decn(&AccDecn);
+	}
+
+//try not to pollute namespace
+#undef BASE
 }
 
 #ifdef USE_POW_SQRT_IMPL
@@ -1303,276 +2168,456 @@ void sqrt_decn(void) {
 	st_push_decn(&BDecn); // sqrt should behave like an unary operation
 	//b = 0.5
 	set_dec80_zero(&BDecn);
-	BDecn.lsu[0] = 5;
+	BDecn.lsu[0] = DIGIT100(5);
 	pow_decn();
 	st_pop_decn(&BDecn);
 }
 #else
+//radicand digit pair k (base 100 digit of the integer part, then the fraction) of x,
+// where x is scaled to between 1 and 100 (by 10 if the exponent is odd)
+static uint8_t sqrt_pair(const dec80* x, uint8_t k, uint8_t exp_is_odd){
+	uint8_t hi = 0, lo = 0;
+	if (exp_is_odd){
+		return (k < DEC80_NUM_LSU) ? x->lsu[k] : 0;
+	}
+	if (k > 0 && k <= DEC80_NUM_LSU){
+		hi = DIGIT100_LO(x->lsu[k - 1]);
+	}
+	if (k < DEC80_NUM_LSU){
+		lo = DIGIT100_HI(x->lsu[k]);
+	}
+	return DIGIT100_MAKE(hi, lo);
+}
+
+//calculate AccDecn = sqrt(AccDecn)
+//digit by digit (like long division), with integer remainder R and root Q:
+// for each root digit, bring down the next 2 digits (R = 100*R + pair), then the
+// digit is the number of times the odd numbers 20*Q + 1, 20*Q + 3, ... can be
+// subtracted from R. Only adds and subtracts, and exact for perfect squares.
+// The 19th digit is used to round the 18 digit root.
+// (at reduced working precision, the root is truncated after 2*DecnNumLsu digits)
 void sqrt_decn(void){
-#define CURR_EST Tmp2Decn //holds current 1/sqrt(x) estimate
-#define X_2      Tmp3Decn //holds copy of original x / 2
-	uint8_t i;
-	exp_t initial_exp;
+#define ROOT      DIGITS_RESULT
+#define REMAINDER FixedDecn  //R, as a 22 digit integer
+#define ODD       Fixed2Decn //20*Q + 1 + 2*(number of times subtracted)
+	uint8_t k, digit, exp_is_odd;
+	int8_t i;
+	exp_t new_exponent;
 	if (decn_is_nan(&AccDecn)) {
 		return;
 	}
+	if (decn_is_zero(&AccDecn)){
+		return;
+	}
 	if (AccDecn.exponent < 0){ //negative
 		set_dec80_NaN(&AccDecn);
 		return;
 	}
-	//normalize
-	remove_leading_zeros(&AccDecn);
+	assert_normalized(&AccDecn);
 #ifdef DEBUG_SQRT
 	decn_to_str_complete(&AccDecn);
 	printf("sqrt in: %s\n", Buf);
 #endif
-	//store copy of x
-	st_push_decn(&AccDecn);
-	//calculate x_orig / 2
-	set_dec80_zero(&BDecn);
-	BDecn.lsu[0] = 5;
-	mult_decn();
-	copy_decn(&X_2, &AccDecn);
-	//restore x
-	st_load_decn(&AccDecn);
-	//get initial estimate for 1/sqrt(x) == 10^(-0.5 * log(x)):
-	// approximate significand == 10^(-0.5 * log(x_signif))
-	//  with linear approximation: -0.18 * x_signif + 2.5
-	// new exponent part is (10^(-0.5 * log(10^x_exp)))
-	//                    == 10^(-0.5 * x^exp)
-	initial_exp = get_exponent(&AccDecn);
-	set_exponent(&AccDecn, 0, 0); //clear exponent (Acc is not negative)
-#ifdef DEBUG_SQRT
-	printf("sqrt exponent %d ", initial_exp);
-#endif
-	if (initial_exp & 0x1){ //odd
-#ifdef DEBUG_SQRT
-		printf("(odd) ");
-#endif
-		//increment x_exp and
-		initial_exp++;
-		//approximate estimated significand as (-0.056*x_signif + 0.79) * 10^0.5
-		//                                  == -0.18 * x_signif + 2.5
-		//b = -0.18
-		BDecn.lsu[0] = 18;
-		BDecn.exponent = -1; //negative, and exponent = -1
-		//a = -0.18 * x_signif
-		mult_decn();
-		//b = 2.5
-		BDecn.lsu[0] = 25;
-		BDecn.exponent = 0;
-		//a = -0.18 * x_signif + 2.5
-		add_decn();
-	} else { //even
-		//keep x_exp as is and approximate estimated significand as
-		//                   -0.056*x_signif + 0.79
-		//b = -0.056
-		BDecn.lsu[0] = 56;
-		set_exponent(&BDecn, -2, 1);
-		//a = -0.056 * x_signif
-		mult_decn();
-		//b = 0.79
-		BDecn.lsu[0] = 7;
-		BDecn.lsu[1] = 90;
-		BDecn.exponent = 0;
-		//a = -0.056*x_signif + 0.79
-		add_decn();
-	}
-	//est_exp = -x_exp / 2;
-	initial_exp = -initial_exp / 2;
-	//est_exp-- if AccDecn exponent is negative
-	// (AccDecn exponent is either 0 or -1, and AccDecn is positive)
-	if (AccDecn.exponent != 0){
-		initial_exp--;
-	}
-	set_exponent(&AccDecn, initial_exp, 0); //(initial estimate is never negative)
-	copy_decn(&CURR_EST, &AccDecn);
-#ifdef DEBUG_SQRT
-	printf(" -> %d\n", initial_exp);
-#endif
-	//do newton-raphson iterations
-	for (i = 0; i < 6; i++){ //just fix number of iterations for now
+	//sqrt(signif * 10^exp) == sqrt(signif * 10^(exp % 2)) * 10^floor(exp / 2)
+	new_exponent = get_exponent(&AccDecn);
+	exp_is_odd = new_exponent & 1;
+	new_exponent = (new_exponent - exp_is_odd) / 2;
+	for (i = 0; i < DECN_FIXED_NUM_LSU; i++){
+		REMAINDER.lsu[i] = 0;
+		ODD.lsu[i] = 0;
+	}
+	ODD.lsu[DECN_FIXED_NUM_LSU - 1] = DIGIT100(1);
+	for (k = 0; ; k++){
+		//R = 100*R + pair (R < 2*10^19, so the most significant digit100 is 0)
+		for (i = 0; i < DECN_FIXED_NUM_LSU - 1; i++){
+			REMAINDER.lsu[i] = REMAINDER.lsu[i + 1];
+		}
+		REMAINDER.lsu[DECN_FIXED_NUM_LSU - 1] = sqrt_pair(&AccDecn, k, exp_is_odd);
+		//subtract successive odd numbers
+		for (digit = 0; !fixed_sub(&REMAINDER, &ODD); digit++){
+			fixed_add2(&ODD);
+		}
+		fixed_add_shifted(&REMAINDER, &REMAINDER, &ODD, 0); //restore
+		if (k == DecnNumLsu * 2){
+			break; //digit is the rounding digit
+		}
+		set_result_digit(k, digit);
+		//ODD == 20*Q + 2*digit + 1, next ODD is 20*(10*Q + digit) + 1 == 10*(ODD - 1) + 1
+		ODD.lsu[DECN_FIXED_NUM_LSU - 1]--; //last digit is odd, so no borrow
+		fixed_shift_left(&ODD);
+		ODD.lsu[DECN_FIXED_NUM_LSU - 1]++;
 #ifdef DEBUG_SQRT
-		decn_to_str_complete(&CURR_EST);
-		printf("sqrt %2d: %s\n", i, Buf);
+		printf("sqrt %2d: digit %d\n", k, digit);
 #endif
-		//accum = est * est;
-		copy_decn(&BDecn, &AccDecn);
-		mult_decn();
-		//accum *= x_orig_2;     //accum = x/2 * est * est
-		copy_decn(&BDecn, &X_2);
-		mult_decn();
-		//accum = - x/2 * est * est
-		negate_decn(&AccDecn);
-		//b = 3/2
-		set_dec80_zero(&BDecn);
-		BDecn.lsu[0] = 15;
-		//accum = 3/2 - x/2 * est * est
-		add_decn();
-		//accum *= est;          //accum = 0.5 * est * (3 - x * est * est)
-		copy_decn(&BDecn, &CURR_EST);
-		mult_decn();
-		//est = accum;
-		copy_decn(&CURR_EST, &AccDecn);
 	}
+	//(sqrt(99.99...9) < 9.99...9|5, so the root can't round up to 10)
+	round_result(digit);
+	set_exponent(&ROOT, new_exponent, 0);
+	copy_reg(&AccDecn, &ROOT);
 
-	//calc sqrt from recip_sqrt
-	st_pop_decn(&BDecn);
-	mult_decn();
-
-#undef CURR_EST
-#undef X_COPY
+//try not to pollute namespace
+#undef ROOT
+#undef REMAINDER
+#undef ODD
 }
 #endif //USE_POW_SQRT_IMPL
 
 
-// normal angle to between 0 and 360 degrees
+// normal (non-negative) angle to between 0 and 360 degrees
 void normalize_0_360(void) {
-	const uint8_t is_negative = (AccDecn.exponent < 0);
-	exp_t exponent;
-
-	remove_leading_zeros(&AccDecn);
-	if (is_negative) {
-		negate_decn(&AccDecn);
-	}
-	exponent = get_exponent(&AccDecn);
 	//B = 360
 	set_dec80_zero(&BDecn);
-	BDecn.lsu[0] = 36;
+	BDecn.lsu[0] = DIGIT100(36);
 	BDecn.exponent = 2;
-	if (compare_magn() > 0) {
-		do {
-			do {
-				//B = 3.6e...
-				BDecn.exponent = exponent;
-				if (compare_magn() >= 0) {
-					negate_decn(&BDecn);
-					add_decn();
-				} else {
-					break;
-				}
-			} while (1);
-			exponent--;
-		} while (exponent >= 2);
-	}
-
-	if (is_negative) {
-		negate_decn(&AccDecn);
-		//B = 360
-		BDecn.exponent = 2;
-		add_decn();
-	}
+	fmod_decn();
 }
 
-// K. Shirriff, "Reversing Sinclair's amazing 1974 calculator hack - half the ROM of the HP-35"
-// http://files.righto.com/calculator/sinclair_scientific_simulator.html
+// see W.E. Egbert, "Personal Calculator Algorithms II: Trigonometric Functions"
+// and "Personal Calculator Algorithms III: Inverse Trigonometric Functions"
+// decimal CORDIC: pseudo-division of the angle by atan(10^-j), followed by
+// pseudo-multiplication (rotation of a vector by atan(10^-j)), or vice versa for arctan
+//(constants used for trig functions are the fixed point ATAN_A_ARR[] above)
+
 #define SIN Tmp2Decn
 #define COS Tmp3Decn
 #define THETA Tmp4Decn
-void sincos_decn(const uint8_t sincos_arctan) {
-	const uint8_t is_negative = AccDecn.exponent < 0;
-	if (sincos_arctan) { //calculate arctan
-		set_dec80_zero(&THETA);
-		if (is_negative) negate_decn(&AccDecn);
-		copy_decn(&COS, &AccDecn);
-		set_decn_one(&SIN);
-	} else { //calculate sin/cos
-		normalize_0_360();
-		to_radian_decn();
-		copy_decn(&THETA, &AccDecn);
-		set_decn_one(&COS);
-		set_dec80_zero(&SIN);
-		// 0.0 00 5
-		SIN.lsu[2] = 50;
-		negate_decn(&SIN);
-	}
-	do {
-		if (sincos_arctan) { //calculate arctan
-			// THETA is in AccDecn from previous iteration
-			if (COS.exponent < 0) {
-				if (is_negative) negate_decn(&AccDecn);
-				break;
-			}
-		} else { //calculate sin/cos
-			if (THETA.exponent < 0) {
-				break;
-			}
+
+//BDecn = +/- x * 10^-j (exact, only the exponent changes)
+static void load_b_scaled(const dec80* x, uint8_t j, uint8_t negate){
+	copy_decn(&BDecn, x);
+	set_exponent(&BDecn, get_exponent(&BDecn) - j, (BDecn.exponent < 0) ^ negate);
+}
+
+//rotate vector (COS, SIN) by +/- atan(10^-j)
+// when rotating clockwise (direction < 0), only rotate if SIN stays non-negative
+// (returns 0 if not rotated)
+static uint8_t cordic_step(uint8_t j, int8_t direction){
+	//new SIN = SIN +/- COS*10^-j
+	copy_reg(&AccDecn, &SIN);
+	load_b_scaled(&COS, j, direction < 0);
+	add_decn();
+	if (direction < 0 && AccDecn.exponent < 0){ //rotated past 0
+		return 0;
+	}
+	st_push_decn(&AccDecn);
+	//new COS = COS -/+ SIN*10^-j
+	copy_reg(&AccDecn, &COS);
+	load_b_scaled(&SIN, j, direction > 0);
+	add_decn();
+	copy_reg(&COS, &AccDecn);
+	st_pop_decn(&SIN);
+
+	return 1;
+}
+
+//number of atan(10^-j) constants used by the CORDIC functions at the working precision
+// (the remaining angle r is below 10^-(num - 1), and tan(r) ~= r is accurate to about r^3/3)
+static uint8_t cordic_num_steps(void){
+	return (DecnNumLsu < DECN_NUM_ATAN_A_ARR) ? DecnNumLsu : DECN_NUM_ATAN_A_ARR;
+}
+
+//calculate SIN and COS of AccDecn (in radians, 0 <= AccDecn < 1)
+// SIN and COS are both scaled by the same (unknown) factor
+static void cordic_rotate(void){
+	uint8_t j, k;
+	uint8_t num_steps = cordic_num_steps();
+	uint8_t rotated = 0;
+	//pseudo-division: track number of times atan(10^-j) can be subtracted
+	// (in fixed point, so that the subtractions are exact)
+	decn_to_fixed(&FixedDecn, &AccDecn);
+	for (j = 0; j < num_steps; j++){
+		k = 0;
+		while (!fixed_sub(&FixedDecn, &ATAN_A_ARR[j])){ //while not negative
+			k++;
 		}
-		// COS = COS - SIN / 1000
-		copy_decn(&AccDecn, &COS);
-		copy_decn(&BDecn, &SIN);
-		shift_right(&BDecn);
-		shift_right(&BDecn);
-		shift_right(&BDecn);
-		negate_decn(&BDecn);
-		add_decn();
-		copy_decn(&COS, &AccDecn);
-		// SIN = SIN + COS / 1000
-		copy_decn(&AccDecn, &SIN);
-		copy_decn(&BDecn, &COS);
-		shift_right(&BDecn);
-		shift_right(&BDecn);
-		shift_right(&BDecn);
+		//subtracted 1 time too many: restore
+		fixed_add_shifted(&FixedDecn, &FixedDecn, &ATAN_A_ARR[j], 0);
+		NumTimes[j] = k;
+		rotated |= k;
+#ifdef DEBUG_TRIG
+		printf("cordic num_times for %d: %d\n", j, k);
+#endif
+	}
+	//remainder is small enough that tan(remainder) == remainder
+	// (if nothing was subtracted, use the angle itself: tiny angles would lose
+	//  their digits in the fixed point register)
+	if (rotated){
+		fixed_to_decn(&SIN, &FixedDecn);
+	} else {
+		copy_reg(&SIN, &AccDecn);
+	}
+	set_decn_one(&COS);
+	//pseudo-multiplication: rotate back by the subtracted angles
+	for (j = num_steps - 1; j < DECN_NUM_ATAN_A_ARR; j--){ //note: (j < DECN_NUM_ATAN_A_ARR) == signed(j >= 0)
+		for (k = 0; k < NumTimes[j]; k++){
+			cordic_step(j, 1);
+		}
+	}
+#ifdef DEBUG_TRIG
+	decn_to_str_complete(&SIN);
+	printf("cordic sin: %s, ", Buf);
+	decn_to_str_complete(&COS);
+	printf("cos: %s\n", Buf);
+#endif
+}
+
+//calculate AccDecn = atan(SIN/COS) (in radians), SIN and COS must be non-negative
+static void cordic_vector(void){
+	uint8_t j;
+	uint8_t num_steps = cordic_num_steps();
+	uint8_t rotated = 0;
+	//angle is summed in fixed point, so that the additions are exact
+	for (j = 0; j < DECN_FIXED_NUM_LSU; j++){
+		FixedDecn.lsu[j] = 0;
+	}
+	//rotate vector towards 0 while tracking angle
+	for (j = 0; j < num_steps; j++){
+		while (cordic_step(j, -1)){
+			fixed_add_shifted(&FixedDecn, &FixedDecn, &ATAN_A_ARR[j], 0);
+			rotated = 1;
+		}
+	}
+	//remaining angle is small enough that atan(SIN/COS) == SIN/COS
+	copy_reg(&AccDecn, &SIN);
+	copy_reg(&BDecn, &COS);
+	div_decn();
+	if (!rotated){
+		return; //tiny angles would lose their digits in the fixed point register
+	}
+	decn_to_fixed(&Fixed2Decn, &AccDecn);
+	fixed_add_shifted(&FixedDecn, &FixedDecn, &Fixed2Decn, 0);
+	fixed_to_decn(&AccDecn, &FixedDecn);
+}
+
+//x = deg (deg must be between 10 and 99 degrees)
+static void set_degrees(dec80* x, uint8_t deg){
+	set_dec80_zero(x);
+	x->lsu[0] = DIGIT100(deg);
+	x->exponent = 1;
+}
+
+//round AccDecn to 16 digits
+// the last digit100 holds guard digits for the trig functions, which lose a few
+// digits of precision, so that e.g. sin(30) and asin(0.5) give exactly 0.5 and 30
+static void round_trig(void){
+	int8_t i;
+	uint8_t digit;
+	if (decn_is_nan(&AccDecn)){
+		return;
+	}
+	digit = DIGIT100_VAL(AccDecn.lsu[DEC80_NUM_LSU - 1]);
+	AccDecn.lsu[DEC80_NUM_LSU - 1] = 0;
+	//round half up
+	if (digit >= 50){
+		for (i = DEC80_NUM_LSU - 2; i >= 0 && AccDecn.lsu[i] == DIGIT100(99); i--){
+			AccDecn.lsu[i] = 0;
+		}
+		if (i < 0){ //rounded up from 9.99...9 to 10
+			AccDecn.lsu[0] = DIGIT100(10);
+			set_exponent(&AccDecn, get_exponent(&AccDecn) + 1, (AccDecn.exponent < 0));
+		} else {
+			digit = DIGIT100_VAL(AccDecn.lsu[i]) + 1;
+			AccDecn.lsu[i] = DIGIT100(digit);
+		}
+	}
+}
+
+//exchange SIN and COS (AccDecn is overwritten)
+static void swap_sincos(void){
+	copy_reg(&AccDecn, &SIN);
+	copy_reg(&SIN, &COS);
+	copy_reg(&COS, &AccDecn);
+}
+
+//negate x, unless it is 0 (so that e.g. cos(90) is 0 and not -0)
+static void negate_nonzero(dec80* x){
+	if (!decn_is_zero(x)){
+		negate_decn(x);
+	}
+}
+
+//calculate SIN and COS of AccDecn (in degrees)
+// SIN and COS are both scaled by the same (unknown) factor
+//the angle is reduced to 0..45 degrees before converting to radians: in degrees, the
+// subtractions of 90 and 45 are exact, so that SIN or COS is exactly 0 on the axes
+//returns 0 if AccDecn is NaN (AccDecn is left as NaN, SIN and COS aren't calculated)
+static uint8_t sincos_decn(void){
+	const uint8_t is_negative = AccDecn.exponent < 0;
+	uint8_t quadrant = 0;
+	uint8_t swap = 0;
+	if (decn_is_nan(&AccDecn)){
+		return 0;
+	}
+	if (is_negative) negate_decn(&AccDecn);
+	normalize_0_360();
+	//subtract 90 degrees until negative
+	set_degrees(&BDecn, 90);
+	negate_decn(&BDecn);
+	while (!(AccDecn.exponent < 0)){ //while not negative
+		copy_reg(&SIN, &AccDecn); //save = accum
 		add_decn();
-		copy_decn(&SIN, &AccDecn);
-		// THETA = THETA -/+ 0.0 01
-		copy_decn(&AccDecn, &THETA);
-		set_dec80_zero(&BDecn);
-		BDecn.lsu[1] = 1;
-		if (!sincos_arctan) negate_decn(&BDecn);
+		quadrant++;
+	}
+	//subtracted 1 time too many
+	quadrant--;
+	copy_reg(&AccDecn, &SIN); //restore
+	//angle above 45 degrees: use 45 - (angle - 45), with sin and cos swapped
+	set_degrees(&BDecn, 45);
+	negate_decn(&BDecn);
+	add_decn();
+	if (AccDecn.exponent < 0 || decn_is_zero(&AccDecn)){
+		copy_reg(&AccDecn, &SIN); //restore
+	} else {
+		negate_decn(&AccDecn);
+		negate_decn(&BDecn);
 		add_decn();
+		swap = 1;
+	}
+	to_radian_decn();
+	cordic_rotate();
+	//sin(x + 90) == cos(x), cos(x + 90) == -sin(x)
+	if (swap ^ (quadrant & 1)){
+		swap_sincos();
+	}
+	if (quadrant == 1 || quadrant == 2){
+		negate_nonzero(&COS);
+	}
+	//sin(-x) == -sin(x), cos(-x) == cos(x)
+	if ((quadrant >= 2) ^ is_negative){
+		negate_nonzero(&SIN);
+	}
+	return 1;
+}
+
+//divide out scale factor from cordic_rotate():
+// AccDecn = x/sqrt(SIN^2 + COS^2), x must be SIN or COS
+static void sincos_unscale(__idata dec80* x){
+	copy_reg(&AccDecn, &COS);
+	copy_reg(&BDecn, &COS);
+	mult_decn();
+	//SIN^2 is negligible next to COS^2 for tiny angles (and could underflow)
+	// (an angle this small is never reduced from a larger one, so COS is near 1)
+	if (get_exponent(&SIN) > -2 * DEC80_NUM_LSU){
 		copy_decn(&THETA, &AccDecn);
-	} while (1);
+		copy_reg(&AccDecn, &SIN);
+		copy_reg(&BDecn, &SIN);
+		fma_decn(&THETA);
+	}
+	//sqrt_decn() and recip_decn() overwrite SIN
+	st_push_decn(&SIN);
+	sqrt_decn();
+	recip_decn();
+	st_pop_decn(&SIN);
+	copy_reg(&BDecn, x);
+	mult_decn();
+	round_trig();
 }
 
 void sin_decn(void) {
-	sincos_decn(0);
-	copy_decn(&AccDecn, &SIN);
+	if (!sincos_decn()) return;
+	sincos_unscale(&SIN);
 }
 
 void cos_decn(void) {
-	sincos_decn(0);
-	copy_decn(&AccDecn, &COS);
+	if (!sincos_decn()) return;
+	sincos_unscale(&COS);
 }
 
 void tan_decn(void) {
-	sincos_decn(0);
-	copy_decn(&AccDecn, &SIN);
-	copy_decn(&BDecn, &COS);
+	//scale factor cancels out
+	if (!sincos_decn()) return;
+	if (decn_is_zero(&COS)){ //pole at 90 + 180*n degrees
+		set_dec80_NaN(&AccDecn);
+		return;
+	}
+	copy_reg(&AccDecn, &SIN);
+	copy_reg(&BDecn, &COS);
 	div_decn();
+	round_trig();
 }
 
-void arctan_decn(void) {
-	sincos_decn(1);
+//AccDecn = atan(SIN/COS) (in degrees), SIN and COS must be non-negative
+static void arctan_degrees(void){
+	if (decn_is_zero(&COS)){
+		set_degrees(&AccDecn, 90);
+		return;
+	}
+	cordic_vector();
 	to_degree_decn();
 }
 
-// see W.E. Egbert, "Personal Calculator Algorithms III: Inverse Trigonometric Functions"
-void arcsin_decn_rad(void) {
+void arctan_decn(void) {
+	const uint8_t is_negative = AccDecn.exponent < 0;
+	if (decn_is_nan(&AccDecn)){
+		return;
+	}
+	if (is_negative) negate_decn(&AccDecn);
+	copy_reg(&SIN, &AccDecn);
+	set_decn_one(&COS);
+	arctan_degrees();
+	round_trig();
+	if (is_negative) negate_nonzero(&AccDecn);
+}
+
+//SIN = |x|, COS = sqrt(1 - x^2), so that asin(x) = atan(SIN/COS) and acos(|x|) = atan(COS/SIN)
+//returns 0 if x is NaN or |x| > 1 (AccDecn is set to NaN)
+// (at |x| == 1, COS is exactly 0)
+static uint8_t arcsin_vector(void){
+	uint8_t i;
+	if (decn_is_nan(&AccDecn)){
+		return 0;
+	}
+	if (AccDecn.exponent < 0) negate_decn(&AccDecn);
+	//1 - x^2 = (1 - x)*(1 + x), with 1 - x calculated exactly in fixed point
+	// (1 - x^2 cancels near |x| == 1)
+	if (get_exponent(&AccDecn) > 0){ //|x| >= 10
+		set_dec80_NaN(&AccDecn);
+		return 0;
+	}
+	decn_to_fixed(&FixedDecn, &AccDecn);
+	Fixed2Decn.lsu[0] = DIGIT100(10);
+	for (i = 1; i < DECN_FIXED_NUM_LSU; i++){
+		Fixed2Decn.lsu[i] = 0;
+	}
+	if (fixed_sub(&Fixed2Decn, &FixedDecn)){ //|x| > 1
+		set_dec80_NaN(&AccDecn);
+		return 0;
+	}
 	st_push_decn(&AccDecn);
-	copy_decn(&BDecn, &AccDecn);
+	fixed_to_decn(&COS, &Fixed2Decn); //1 - x
+	copy_reg(&BDecn, &AccDecn);
+	set_decn_one(&AccDecn);
+	add_decn(); //1 + x
+	copy_reg(&BDecn, &COS);
 	mult_decn();
-	negate_decn(&AccDecn);
-	set_decn_one(&BDecn);
-	add_decn();
 	sqrt_decn();
-	recip_decn();
-	st_pop_decn(&BDecn);
-	mult_decn();
-	sincos_decn(1);
+	copy_reg(&COS, &AccDecn);
+	st_pop_decn(&SIN);
+	return 1;
 }
 
 void arcsin_decn(void) {
-	arcsin_decn_rad();
-	to_degree_decn();
+	const uint8_t is_negative = AccDecn.exponent < 0;
+	if (!arcsin_vector()) return;
+	arctan_degrees();
+	round_trig();
+	if (is_negative) negate_nonzero(&AccDecn);
 }
 
 void arccos_decn(void) {
-	arcsin_decn_rad();
-	negate_decn(&AccDecn);
-	copy_decn(&BDecn, &DECN_PI2);
-	add_decn();
-	to_degree_decn();
+	const uint8_t is_negative = AccDecn.exponent < 0;
+	if (!arcsin_vector()) return;
+	//acos(|x|) = atan(sqrt(1 - x^2) / |x|), accurate near |x| == 1
+	swap_sincos();
+	arctan_degrees();
+	//acos(-x) == 180 - acos(x)
+	if (is_negative){
+		negate_decn(&AccDecn);
+		set_degrees(&BDecn, 18);
+		BDecn.exponent = 2; //180
+		add_decn();
+	}
+	round_trig();
 }
 #undef SIN
 #undef COS
@@ -1584,8 +2629,8 @@ void to_degree_decn(void) {
 }
 
 void to_radian_decn(void) {
-	copy_decn(&BDecn, &DECN_1RAD);
-	div_decn();
+	copy_decn(&BDecn, &DECN_1DEG);
+	mult_decn();
 }
 
 void pi_decn(void) {
@@ -1613,7 +2658,6 @@ decn_to_str(const dec80* x){
 	exp_t exponent = 0;
 	uint8_t trailing_zeros = 0;
 	uint8_t use_sci = 0;
-	static __xdata dec80 tmp;
 
 	//handle corner case of NaN
 	if (decn_is_nan(x)){
@@ -1624,11 +2668,9 @@ decn_to_str(const dec80* x){
 		return 0;
 	}
 
-	//copy and normalize
-	copy_decn(&tmp, x);
-	remove_leading_zeros(&tmp);
+	assert_normalized(x);
 	//handle corner case of 0
-	if (tmp.lsu[0] == 0){
+	if (x->lsu[0] == 0){
 #ifdef DEBUG
 		printf ("  corner case, set to 0  ");
 #endif
@@ -1637,7 +2679,7 @@ decn_to_str(const dec80* x){
 		return 0;
 	}
 	//check sign of number
-	if (tmp.exponent < 0){
+	if (x->exponent < 0){
 #ifdef DEBUG
 		printf ("  negative  ");
 #endif
@@ -1645,7 +2687,7 @@ decn_to_str(const dec80* x){
 		i++;
 	}
 	//check if we should use scientific notation
-	exponent = get_exponent(&tmp);
+	exponent = get_exponent(x);
 	if (exponent > (num_digits_display - 1) || exponent < -3){
 		use_sci = 1;
 	}
@@ -1663,7 +2705,7 @@ decn_to_str(const dec80* x){
 		}
 	}
 	//print 1st digit
-	Buf[i] = (tmp.lsu[0] / 10) + '0';
+	Buf[i] = DIGIT100_HI(x->lsu[0]) + '0';
 	i++;
 	if (use_sci) {
 		INSERT_DOT();
@@ -1674,8 +2716,8 @@ decn_to_str(const dec80* x){
 		exponent--;
 	}
 	//print 2nd digit
-	Buf[i] = (tmp.lsu[0] % 10) + '0';
-	if (tmp.lsu[0] % 10 == 0 && (use_sci || exponent < 0)){
+	Buf[i] = DIGIT100_LO(x->lsu[0]) + '0';
+	if (DIGIT100_LO(x->lsu[0]) == 0 && (use_sci || exponent < 0)){
 
 		trailing_zeros = 1;
 	}
@@ -1689,7 +2731,7 @@ decn_to_str(const dec80* x){
 	//print rest of significand
 	for (digit100 = 1 ; digit100 < num_digits_display/2; digit100++){
 		//print 1st digit
-		Buf[i] = (tmp.lsu[digit100] / 10) + '0';
+		Buf[i] = DIGIT100_HI(x->lsu[digit100]) + '0';
 		i++;
 		if (!use_sci){
 			if (exponent == 0){
@@ -1698,7 +2740,7 @@ decn_to_str(const dec80* x){
 			exponent--;
 		}
 		//print 2nd digit
-		Buf[i] = (tmp.lsu[digit100] % 10) + '0';
+		Buf[i] = DIGIT100_LO(x->lsu[digit100]) + '0';
 		i++;
 		if (!use_sci){
 			if (exponent == 0){
@@ -1707,13 +2749,13 @@ decn_to_str(const dec80* x){
 			exponent--;
 		}
 		//track trailing 0s
-		if (tmp.lsu[digit100] == 0 && (use_sci || exponent < 0)){
+		if (x->lsu[digit100] == 0 && (use_sci || exponent < 0)){
 			if (use_sci || exponent < -2){ //xx.00
 				trailing_zeros += 2;
 			} else if (exponent == -2){ //xx.0
 				trailing_zeros += 1;
 			}
-		} else if (tmp.lsu[digit100]%10 == 0 && (use_sci || exponent < 0)){
+		} else if (DIGIT100_LO(x->lsu[digit100]) == 0 && (use_sci || exponent < 0)){
 			trailing_zeros = 1;
 		} else {
 			trailing_zeros = 0;
@@ -1727,7 +2769,7 @@ decn_to_str(const dec80* x){
 	Buf[i] = '\0';
 
 	//calculate exponent
-	exponent = get_exponent(&tmp); //base 100
+	exponent = get_exponent(x); //base 100
 #ifdef DEBUG
 	printf ("  exponent (%d)", exponent);
 #endif
@@ -1750,7 +2792,7 @@ decn_to_str(const dec80* x){
 #ifdef DEBUG
 	printf ("  final i (%d)  ", i);
 	for (int jjj = 0; jjj < DEC80_NUM_LSU; jjj++){
-		printf(" %02d", tmp.lsu[jjj]);
+		printf(" %02d", DIGIT100_VAL(x->lsu[jjj]));
 	}
 	printf("\n");
 #endif
@@ -1783,5 +2825,164 @@ void build_decn_at(dec80* dest, const char* signif_str, exp_t exponent){
 	copy_decn(&AccDecn, &tmp); //restore
 }
 
+//values are processed in blocks of this many
+#define DECN_BATCH_BLOCK 64
+
+//block of values in structure-of-arrays layout: digit100 k of every value is
+// contiguous, so that loops over the values of a block can be vectorized
+typedef struct {
+	exp_t exponent[DECN_BATCH_BLOCK];
+	uint8_t lsu[DEC80_NUM_LSU][DECN_BATCH_BLOCK];
+} decn_soa;
+
+//the rest of a partial block is filled with zeros
+static void load_soa(decn_soa* dst, const dec80* src, size_t n){
+	size_t v;
+	uint8_t k;
+	for (v = 0; v < DECN_BATCH_BLOCK; v++){
+		dst->exponent[v] = (v < n) ? src[v].exponent : 0;
+		for (k = 0; k < DEC80_NUM_LSU; k++){
+			dst->lsu[k][v] = (v < n) ? src[v].lsu[k] : 0;
+		}
+	}
+}
+
+//mult_columns() for a block of values of a and b at once: the most significant
+// DEC80_NUM_LSU digit100s of each product are stored in prod, and the carries out
+// of them in carry
+//(the loops over the values always cover the whole block, so that compilers
+// vectorize them)
+static void mult_columns_soa(decn_soa* prod, uint16_t* carry, const decn_soa* a, const decn_soa* b){
+	uint32_t column[DECN_BATCH_BLOCK];
+	size_t v;
+	int8_t i, j, k;
+	for (v = 0; v < DECN_BATCH_BLOCK; v++){
+		carry[v] = 0;
+	}
+	for (k = 2 * (DEC80_NUM_LSU - 1); k >= 0; k--){
+		for (v = 0; v < DECN_BATCH_BLOCK; v++){
+			column[v] = carry[v];
+		}
+		// i + j == k
+		i = (k < DEC80_NUM_LSU) ? 0 : k - (DEC80_NUM_LSU - 1);
+		for (j = k - i; i < DEC80_NUM_LSU && j >= 0; i++, j--){
+			const uint8_t* a_i = a->lsu[i];
+			const uint8_t* b_j = b->lsu[j];
+			for (v = 0; v < DECN_BATCH_BLOCK; v++){
+				column[v] += (uint16_t) DIGIT100_VAL(a_i[v]) * DIGIT100_VAL(b_j[v]);
+			}
+		}
+		for (v = 0; v < DECN_BATCH_BLOCK; v++){
+			carry[v] = column[v] / 100;
+		}
+		if (k < DEC80_NUM_LSU){
+			for (v = 0; v < DECN_BATCH_BLOCK; v++){
+				prod->lsu[k][v] = DIGIT100(column[v] - carry[v] * 100);
+			}
+		}
+	}
+}
+
+//dst[i] = a[i] * b[i], without changing the current context's registers
+void mult_decn_n(dec80* dst, const dec80* a, const dec80* b, size_t n){
+	decn_soa a_soa, b_soa, prod;
+	uint16_t carry[DECN_BATCH_BLOCK];
+	decn_ctx ctx;
+	decn_ctx* prev = use_decn_ctx(&ctx);
+	size_t block, v;
+	uint8_t k;
+	init_decn_ctx(&ctx);
+	for (block = 0; block < n; block += DECN_BATCH_BLOCK){
+		size_t block_n = (n - block < DECN_BATCH_BLOCK) ? n - block : DECN_BATCH_BLOCK;
+		load_soa(&a_soa, &a[block], block_n);
+		load_soa(&b_soa, &b[block], block_n);
+		mult_columns_soa(&prod, carry, &a_soa, &b_soa);
+		//sign, exponent, and normalization of each product
+		for (v = 0; v < block_n; v++){
+			const dec80* x = &a[block + v];
+			const dec80* y = &b[block + v];
+			if (decn_is_nan(x) || decn_is_nan(y)){
+				set_dec80_NaN(&dst[block + v]);
+				continue;
+			}
+			assert_normalized(x);
+			assert_normalized(y);
+			for (k = 0; k < DEC80_NUM_LSU; k++){
+				TmpDecn.lsu[k] = prod.lsu[k][v];
+			}
+			//carry < 100 for non-NaN values
+			mult_finish(x, y, (uint8_t) carry[v]);
+			copy_decn(&dst[block + v], &AccDecn);
+		}
+	}
+	use_decn_ctx(prev);
+}
+
+//dst[i] = op(a[i], b[i]) (b is NULL for functions of a single value), one value
+// at a time in a separate context
+static void apply_decn_n(void (*op)(void), dec80* dst, const dec80* a, const dec80* b, size_t n){
+	decn_ctx ctx;
+	decn_ctx* prev = use_decn_ctx(&ctx);
+	size_t i;
+	init_decn_ctx(&ctx);
+	for (i = 0; i < n; i++){
+		copy_decn(&AccDecn, &a[i]);
+		if (b){
+			copy_decn(&BDecn, &b[i]);
+		}
+		op();
+		copy_decn(&dst[i], &AccDecn);
+	}
+	use_decn_ctx(prev);
+}
+
+void add_decn_n(dec80* dst, const dec80* a, const dec80* b, size_t n){
+	apply_decn_n(add_decn, dst, a, b, n);
+}
+
+void div_decn_n(dec80* dst, const dec80* a, const dec80* b, size_t n){
+	apply_decn_n(div_decn, dst, a, b, n);
+}
+
+void pow_decn_n(dec80* dst, const dec80* a, const dec80* b, size_t n){
+	apply_decn_n(pow_decn, dst, a, b, n);
+}
+
+void recip_decn_n(dec80* dst, const dec80* a, size_t n){
+	apply_decn_n(recip_decn, dst, a, NULL, n);
+}
+
+void sqrt_decn_n(dec80* dst, const dec80* a, size_t n){
+	apply_decn_n(sqrt_decn, dst, a, NULL, n);
+}
+
+void ln_decn_n(dec80* dst, const dec80* a, size_t n){
+	apply_decn_n(ln_decn, dst, a, NULL, n);
+}
+
+void log10_decn_n(dec80* dst, const dec80* a, size_t n){
+	apply_decn_n(log10_decn, dst, a, NULL, n);
+}
+
+void exp_decn_n(dec80* dst, const dec80* a, size_t n){
+	apply_decn_n(exp_decn, dst, a, NULL, n);
+}
+
+void exp10_decn_n(dec80* dst, const dec80* a, size_t n){
+	apply_decn_n(exp10_decn, dst, a, NULL, n);
+}
+
+void sin_decn_n(dec80* dst, const dec80* a, size_t n){
+	apply_decn_n(sin_decn, dst, a, NULL, n);
+}
+
+void cos_decn_n(dec80* dst, const dec80* a, size_t n){
+	apply_decn_n(cos_decn, dst, a, NULL, n);
+}
+
+void tan_decn_n(dec80* dst, const dec80* a, size_t n){
+	apply_decn_n(tan_decn, dst, a, NULL, n);
+}
+
 #endif //DESKTOP
 
@@ -22,6 +22,9 @@
 
 #include <stdint.h>
 #include "../utils.h"
+#ifdef DESKTOP
+#include <stddef.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -29,6 +32,39 @@ extern "C" {
 
 #define DEC80_NUM_LSU 9
 
+//digit100s are stored in binary (0 to 99) by default, or as packed BCD
+// (0x00 to 0x99) when DECN_PACKED_BCD is defined: the 8051 can then add using
+// DA A, and shift digits using nibble swaps
+// #define DECN_PACKED_BCD
+
+#ifdef DECN_PACKED_BCD
+#define DIGIT100(x)           ((uint8_t) ((((x) / 10) << 4) | ((x) % 10))) //value to stored digit100
+#define DIGIT100_VAL(d)       ((uint8_t) (((d) >> 4) * 10 + ((d) & 0x0f))) //stored digit100 to value
+#define DIGIT100_HI(d)        ((d) >> 4)   //most significant digit of stored digit100
+#define DIGIT100_LO(d)        ((d) & 0x0f) //least significant digit of stored digit100
+#define DIGIT100_MAKE(hi, lo) ((uint8_t) (((hi) << 4) | (lo)))
+#else
+#define DIGIT100(x)           (x)
+#define DIGIT100_VAL(d)       (d)
+#ifdef DECN_LARGE_CODE
+//digits of each digit100, packed into nibbles (like DECN_PACKED_BCD), so that
+// splitting a digit100 is a table lookup instead of a division
+extern __code const uint8_t DIGIT100_DIGITS[100];
+#define DIGIT100_HI(d)        (DIGIT100_DIGITS[d] >> 4)
+#define DIGIT100_LO(d)        (DIGIT100_DIGITS[d] & 0x0f)
+#else
+//(dividing is slower, but the table does not fit in the calculator's code space)
+#define DIGIT100_HI(d)        ((d) / 10)
+#define DIGIT100_LO(d)        ((d) % 10)
+#endif
+#define DIGIT100_MAKE(hi, lo) ((hi) * 10 + (lo))
+#endif
+
+//initializer for the digit100s of a constant
+#define DEC80_LSU(d0, d1, d2, d3, d4, d5, d6, d7, d8) { \
+	DIGIT100(d0), DIGIT100(d1), DIGIT100(d2), DIGIT100(d3), DIGIT100(d4), \
+	DIGIT100(d5), DIGIT100(d6), DIGIT100(d7), DIGIT100(d8) }
+
 #define EXP16
 
 #ifdef EXP16
@@ -57,19 +93,106 @@ typedef struct {
 	//implicit decimal point between (lsu[0]/10) and (lsu[0]%10)
 } dec80;
 
+//fixed point significand for the ln(), exp(), and trig pseudo-division/pseudo-multiplication
+// digit100s as in dec80, with 2 extra guard digit100s
+// (decimal point between (lsu[0]/10) and (lsu[0]%10), so 0 <= value < 10)
+#define DECN_FIXED_NUM_LSU (DEC80_NUM_LSU + 2)
+typedef struct {
+	uint8_t lsu[DECN_FIXED_NUM_LSU];
+} decn_fixed;
+
+//initializer for the digit100s of a fixed point constant
+#define DECN_FIXED_LSU(d0, d1, d2, d3, d4, d5, d6, d7, d8, d9, d10) { { \
+	DIGIT100(d0), DIGIT100(d1), DIGIT100(d2), DIGIT100(d3), DIGIT100(d4), \
+	DIGIT100(d5), DIGIT100(d6), DIGIT100(d7), DIGIT100(d8), DIGIT100(d9), \
+	DIGIT100(d10) } }
+
+//number of ln(1 + 10^-j) constants used for ln() and exp()
+#define DECN_NUM_LN_A_ARR 11
+
+//number of atan(10^-j) constants used for the trig functions
+#define DECN_NUM_ATAN_A_ARR 9
+
 //remove sign bit, and return 15 bit exponent sign-extended to 16 bits
 exp_t get_exponent(const dec80* const x);
 
 void set_exponent(dec80* acc, exp_t exponent, uint8_t num_is_neg);
 
-void remove_leading_zeros(dec80* x);
+//normalize x: shift so that the most significant digit is non-zero
+//all dec80 values produced by the decn functions are normalized (or zero with a 0
+// exponent, or NaN),
+// and the decn functions expect normalized arguments: values built by hand (by
+// setting lsu[] directly) must be normalized with this first
+//x must be in internal RAM (e.g. AccDecn) on the 8051
+void remove_leading_zeros(__idata dec80* x);
+
+#ifdef DECN_CHECK_NORMALIZED
+//debug check for the normalized invariant (most significant digit non-zero, or zero, or NaN)
+// when defined, the decn functions assert that their arguments are normalized
+uint8_t decn_is_normalized(const dec80* x);
+#endif
 
 
 void copy_decn(dec80* const dest, const dec80* const src);
+//faster copy_decn() on the 8051 when both are in external RAM (e.g. the stack)
+void copy_decn_xdata(__xdata dec80* const dest, __xdata const dec80* const src);
+
+//number of temporaries that can be pushed with st_push_decn() (minus 1)
+#define DECN_TMP_STACK_SIZE 4
 
+//Buf should hold at least 18 + 4 + 5 + 1 = 28
+#define DECN_BUF_SIZE 28
+
+#ifdef DESKTOP
+//all working registers used by the decn functions
+// on the desktop, AccDecn, BDecn, Buf, etc. refer to the registers of the current
+// thread's context, so that separate threads can do calculations independently
+typedef struct {
+	dec80 acc;
+	dec80 b;
+	dec80 tmp;
+	dec80 tmp2;
+	dec80 tmp3;
+	dec80 tmp4;
+	dec80 tmp_stack[DECN_TMP_STACK_SIZE];
+	uint8_t tmp_stack_ptr;
+	char buf[DECN_BUF_SIZE];
+	decn_fixed fixed;
+	decn_fixed fixed2;
+	uint8_t num_times[DECN_NUM_LN_A_ARR];
+	uint8_t recip_iterations; //number of newton-raphson iterations used by last recip_decn() (DECN_LARGE_CODE only)
+	uint8_t num_lsu; //working precision in digit100s (see set_decn_precision())
+} decn_ctx;
+
+#if defined(__cplusplus)
+#define DECN_THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+#define DECN_THREAD_LOCAL __declspec(thread)
+#else
+#define DECN_THREAD_LOCAL _Thread_local
+#endif
+
+//current thread's context (initially a default context shared by all threads)
+extern DECN_THREAD_LOCAL decn_ctx* DecnCtx;
+
+//clear all registers of ctx, and select full precision
+void init_decn_ctx(decn_ctx* ctx);
+//use ctx for all following decn calculations in the current thread
+// (NULL selects the default context), returns previously used context
+decn_ctx* use_decn_ctx(decn_ctx* ctx);
+//run op (e.g. add_decn()) on the registers of ctx, in the current thread
+void apply_decn_ctx(decn_ctx* ctx, void (*op)(void));
+
+#define AccDecn     (DecnCtx->acc)
+#define BDecn       (DecnCtx->b)
+#define TmpStackPtr (DecnCtx->tmp_stack_ptr)
+#define Buf         (DecnCtx->buf)
+#define RecipIterations (DecnCtx->recip_iterations)
+#else
 extern dec80 AccDecn;
 extern __idata dec80 BDecn;
 extern __idata uint8_t TmpStackPtr;
+#endif
 
 void build_dec80(__xdata const char* signif_str, __xdata exp_t exponent);
 
@@ -79,11 +202,24 @@ void set_dec80_NaN(dec80* dest);
 uint8_t decn_is_zero(const dec80* x);
 uint8_t decn_is_nan(const dec80* x);
 
+#ifdef DESKTOP
+//working precision: add_decn(), mult_decn(), div_decn(), recip_decn(), sqrt_decn(),
+// ln_decn(), exp_decn() and the trig functions stop early, computing results to only
+// about num_digits significant digits (e.g. 10 or 12, when fewer digits are displayed),
+// which is faster
+//0 (or 2*DEC80_NUM_LSU and above) selects full precision, the default
+//this is a setting of the current context
+//(desktop only: the calculator always uses full precision)
+void set_decn_precision(uint8_t num_digits);
+#endif
+
 void negate_decn(dec80* x);
 void add_decn(void);   //calculate AccDecn -= BDecn (BDecn is preserved)
 void mult_decn(void);  //calculate AccDecn *= BDecn (BDecn is preserved)
+void fma_decn(const dec80* c); //calculate AccDecn = AccDecn * BDecn + c (BDecn is preserved, only fused if DECN_FMA)
 void recip_decn(void);
-void div_decn(void);
+void div_decn(void);   //calculate AccDecn /= BDecn (BDecn is preserved)
+void fmod_decn(void);  //calculate AccDecn = remainder of AccDecn / BDecn (BDecn is preserved)
 
 void ln_decn(void);
 void log10_decn(void);
@@ -103,9 +239,9 @@ void to_degree_decn(void);
 void to_radian_decn(void);
 void pi_decn(void);
 
-//Buf should hold at least 18 + 4 + 5 + 1 = 28
-#define DECN_BUF_SIZE 28
+#ifndef DESKTOP
 extern __xdata char Buf[DECN_BUF_SIZE];
+#endif
 
 #ifdef DESKTOP
 int
@@ -118,13 +254,32 @@ decn_to_str(const dec80* x);
 //complete string including exponent
 void decn_to_str_complete(const dec80* x);
 void build_decn_at(dec80* dest, const char* signif_str, exp_t exponent);
+
+//batch versions of the decn functions, for n values in contiguous arrays:
+// dst[i] = a[i] op b[i], or dst[i] = op(a[i])
+//results are identical to the single value functions at full precision, the current
+// context's registers (and working precision) are not used, and dst may be the same array as a or b
+//mult_decn_n() multiplies blocks of values at once, the others loop over the values
+void add_decn_n(dec80* dst, const dec80* a, const dec80* b, size_t n);
+void mult_decn_n(dec80* dst, const dec80* a, const dec80* b, size_t n);
+void div_decn_n(dec80* dst, const dec80* a, const dec80* b, size_t n);
+void pow_decn_n(dec80* dst, const dec80* a, const dec80* b, size_t n);
+void recip_decn_n(dec80* dst, const dec80* a, size_t n);
+void sqrt_decn_n(dec80* dst, const dec80* a, size_t n);
+void ln_decn_n(dec80* dst, const dec80* a, size_t n);
+void log10_decn_n(dec80* dst, const dec80* a, size_t n);
+void exp_decn_n(dec80* dst, const dec80* a, size_t n);
+void exp10_decn_n(dec80* dst, const dec80* a, size_t n);
+void sin_decn_n(dec80* dst, const dec80* a, size_t n);
+void cos_decn_n(dec80* dst, const dec80* a, size_t n);
+void tan_decn_n(dec80* dst, const dec80* a, size_t n);
 #endif
 
 #ifdef DESKTOP
 #define PRINT_DEC80(n, v) \
 	printf(n " %d %5d: ", v.exponent < 0, get_exponent(&v)); \
 	for (int i = 0; i < DEC80_NUM_LSU; i++) { \
-		printf("%02d ", v.lsu[i]); \
+		printf("%02d ", DIGIT100_VAL(v.lsu[i])); \
 	} \
 	fputc('\n', stdout);
 #else
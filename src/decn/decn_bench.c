@@ -0,0 +1,194 @@
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * decn_bench.c
+ *
+ * compares the batch decn functions (e.g. mult_decn_n()) with a loop over the
+ * single value functions, in values per second
+ * and measures how the thread pool of decn_engine.h scales with the number of threads,
+ * and the latency of the single value functions at reduced working precision
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "decn.h"
+#include "decn_engine.h"
+
+
+#define NUM_VALUES 100000
+#define NUM_ENGINE_VALUES 4000000
+
+typedef void (*batch_fn)(dec80* dst, const dec80* a, const dec80* b, size_t n);
+
+static dec80 A[NUM_VALUES], B[NUM_VALUES];
+static dec80 ResScalar[NUM_VALUES], ResBatch[NUM_VALUES];
+
+static void random_values(dec80* x, size_t n, int positive){
+	size_t i;
+	int k;
+	for (i = 0; i < n; i++){
+		for (k = 0; k < DEC80_NUM_LSU; k++){
+			x[i].lsu[k] = DIGIT100(rand() % 100);
+		}
+		x[i].lsu[0] = DIGIT100(10 + rand() % 90); //normalized
+		set_exponent(&x[i], rand() % 21 - 10, !positive && (rand() & 1));
+	}
+}
+
+//wall clock time (CPU time would add up the time of all threads)
+static double seconds(void){
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench(const char* name, void (*op)(void), batch_fn batch, size_t n){
+	size_t i, mismatches = 0;
+	double start, scalar_time, batch_time;
+
+	start = seconds();
+	for (i = 0; i < n; i++){
+		copy_decn(&AccDecn, &A[i]);
+		copy_decn(&BDecn, &B[i]);
+		op();
+		copy_decn(&ResScalar[i], &AccDecn);
+	}
+	scalar_time = seconds() - start;
+
+	start = seconds();
+	batch(ResBatch, A, B, n);
+	batch_time = seconds() - start;
+
+	for (i = 0; i < n; i++){
+		if (ResScalar[i].exponent != ResBatch[i].exponent ||
+		    memcmp(ResScalar[i].lsu, ResBatch[i].lsu, DEC80_NUM_LSU) != 0){
+			mismatches++;
+		}
+	}
+	printf("%-6s scalar: %10.0f values/s, batch: %10.0f values/s (%.2fx)%s\n",
+		name, n / scalar_time, n / batch_time, scalar_time / batch_time,
+		mismatches ? " MISMATCH" : "");
+}
+
+//adapters for the functions of a single value
+static void ln_n(dec80* dst, const dec80* a, const dec80* b, size_t n){
+	(void) b;
+	ln_decn_n(dst, a, n);
+}
+
+static void exp_n(dec80* dst, const dec80* a, const dec80* b, size_t n){
+	(void) b;
+	exp_decn_n(dst, a, n);
+}
+
+static void sin_n(dec80* dst, const dec80* a, const dec80* b, size_t n){
+	(void) b;
+	sin_decn_n(dst, a, n);
+}
+
+static void bench_engine(const char* name, void (*op)(void), dec80* dst, const dec80* a,
+                         const dec80* b, size_t n){
+	static const unsigned THREADS[] = {1, 2, 4, 8, 0};
+	double single_time = 0;
+	size_t t;
+	for (t = 0; t < sizeof THREADS / sizeof THREADS[0]; t++){
+		double start = seconds(), time;
+		decn_engine_apply(op, dst, a, b, n, THREADS[t]);
+		time = seconds() - start;
+		if (t == 0){
+			single_time = time;
+		}
+		if (THREADS[t]){
+			printf("%-6s %u threads: ", name, THREADS[t]);
+		} else {
+			printf("%-6s all cores: ", name);
+		}
+		printf("%10.0f values/s (%.2fx)\n", n / time, single_time / time);
+	}
+}
+
+//latency of op in ns per value, at each working precision (see set_decn_precision())
+static void bench_precision(const char* name, void (*op)(void), size_t n){
+	static const uint8_t NUM_DIGITS[] = {0, 16, 12, 10, 6};
+	double full_time = 0;
+	size_t i, p;
+	printf("%-6s", name);
+	for (p = 0; p < sizeof NUM_DIGITS / sizeof NUM_DIGITS[0]; p++){
+		double start, time;
+		set_decn_precision(NUM_DIGITS[p]);
+		start = seconds();
+		for (i = 0; i < n; i++){
+			copy_decn(&AccDecn, &A[i]);
+			copy_decn(&BDecn, &B[i]);
+			op();
+		}
+		time = seconds() - start;
+		if (p == 0){
+			full_time = time;
+		}
+		printf(" %8.0f (%5.2fx)", time / n * 1e9, full_time / time);
+	}
+	printf("\n");
+	set_decn_precision(0);
+}
+
+int main(void){
+	dec80* a;
+	dec80* b;
+	dec80* res;
+
+	srand(1);
+	random_values(A, NUM_VALUES, 0);
+	random_values(B, NUM_VALUES, 0);
+
+	bench("add", add_decn, add_decn_n, NUM_VALUES);
+	bench("mult", mult_decn, mult_decn_n, NUM_VALUES);
+	bench("div", div_decn, div_decn_n, NUM_VALUES);
+	bench("sin", sin_decn, sin_n, NUM_VALUES / 10);
+
+	random_values(A, NUM_VALUES, 1);
+	bench("ln", ln_decn, ln_n, NUM_VALUES / 10);
+	bench("exp", exp_decn, exp_n, NUM_VALUES / 10);
+
+	printf("\nlatency in ns at each working precision:\n%-6s %17s %17s %17s %17s %17s\n",
+		"", "full", "16 digits", "12 digits", "10 digits", "6 digits");
+	bench_precision("ln", ln_decn, NUM_VALUES / 10);
+	bench_precision("exp", exp_decn, NUM_VALUES / 10);
+	random_values(A, NUM_VALUES, 0);
+	bench_precision("add", add_decn, NUM_VALUES);
+	bench_precision("mult", mult_decn, NUM_VALUES);
+	bench_precision("div", div_decn, NUM_VALUES);
+	bench_precision("recip", recip_decn, NUM_VALUES);
+	bench_precision("sin", sin_decn, NUM_VALUES / 10);
+	bench_precision("arctan", arctan_decn, NUM_VALUES / 10);
+	printf("\n");
+
+	a = malloc(NUM_ENGINE_VALUES * sizeof(dec80));
+	b = malloc(NUM_ENGINE_VALUES * sizeof(dec80));
+	res = malloc(NUM_ENGINE_VALUES * sizeof(dec80));
+	if (!a || !b || !res){
+		return 1;
+	}
+	random_values(a, NUM_ENGINE_VALUES, 1);
+	random_values(b, NUM_ENGINE_VALUES, 0);
+	bench_engine("mult", mult_decn, res, a, b, NUM_ENGINE_VALUES);
+	bench_engine("ln", ln_decn, res, a, NULL, NUM_ENGINE_VALUES / 4);
+	free(a);
+	free(b);
+	free(res);
+
+	return 0;
+}
@@ -0,0 +1,140 @@
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * decn_engine.cpp
+ *
+ * work-stealing thread pool for the decn functions, see decn_engine.h
+ */
+
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "decn_engine.h"
+
+
+namespace {
+
+//number of values a worker takes at a time
+const size_t CHUNK_SIZE = 256;
+const size_t CACHE_LINE = 64;
+
+//each worker is on its own cache lines, so that workers don't slow each other down
+// by writing to their registers, ranges, or output buffers
+struct alignas(CACHE_LINE) Worker {
+	std::mutex lock;   //protects begin and end
+	size_t begin = 0;  //values [begin, end) haven't been taken yet
+	size_t end = 0;
+	decn_ctx ctx;      //the worker's registers
+	alignas(CACHE_LINE) dec80 out[CHUNK_SIZE]; //results of the current chunk
+};
+
+typedef std::function<void(Worker& worker, size_t begin, size_t end)> chunk_fn;
+
+//take the next chunk of the worker's own values
+bool take_chunk(Worker& worker, size_t& begin, size_t& end){
+	std::lock_guard<std::mutex> guard(worker.lock);
+	if (worker.begin >= worker.end){
+		return false;
+	}
+	begin = worker.begin;
+	end = (worker.end - begin > CHUNK_SIZE) ? begin + CHUNK_SIZE : worker.end;
+	worker.begin = end;
+	return true;
+}
+
+//move the second half of the values left to another worker to this worker
+bool steal(std::vector<Worker>& workers, size_t self){
+	for (size_t i = 1; i < workers.size(); i++){
+		Worker& victim = workers[(self + i) % workers.size()];
+		size_t begin, end;
+		{
+			std::lock_guard<std::mutex> guard(victim.lock);
+			if (victim.begin >= victim.end){
+				continue;
+			}
+			begin = victim.begin + (victim.end - victim.begin) / 2;
+			end = victim.end;
+			victim.end = begin; //(takes the last value, if only 1 is left)
+		}
+		std::lock_guard<std::mutex> guard(workers[self].lock);
+		workers[self].begin = begin;
+		workers[self].end = end;
+		return true;
+	}
+	return false;
+}
+
+//call fn for chunks of values [0, n), on num_threads threads
+void run_chunks(const chunk_fn& fn, size_t n, unsigned num_threads){
+	if (num_threads == 0){
+		num_threads = std::thread::hardware_concurrency();
+	}
+	if (num_threads == 0){
+		num_threads = 1;
+	}
+	std::vector<Worker> workers(num_threads);
+	for (size_t t = 0; t < num_threads; t++){
+		workers[t].begin = n * t / num_threads;
+		workers[t].end = n * (t + 1) / num_threads;
+		init_decn_ctx(&workers[t].ctx);
+	}
+
+	auto work = [&](size_t t){
+		Worker& worker = workers[t];
+		decn_ctx* prev = use_decn_ctx(&worker.ctx);
+		size_t begin, end;
+		while (take_chunk(worker, begin, end) || (steal(workers, t) && take_chunk(worker, begin, end))){
+			fn(worker, begin, end);
+		}
+		use_decn_ctx(prev);
+	};
+
+	//this thread is worker 0
+	std::vector<std::thread> threads;
+	for (size_t t = 1; t < num_threads; t++){
+		threads.emplace_back(work, t);
+	}
+	work(0);
+	for (auto& thread : threads){
+		thread.join();
+	}
+}
+
+} //namespace
+
+void decn_engine_run(void (*job)(size_t i, void* arg), void* arg, size_t n, unsigned num_threads){
+	run_chunks([=](Worker&, size_t begin, size_t end){
+		for (size_t i = begin; i < end; i++){
+			job(i, arg);
+		}
+	}, n, num_threads);
+}
+
+void decn_engine_apply(void (*op)(void), dec80* dst, const dec80* a, const dec80* b,
+                       size_t n, unsigned num_threads){
+	run_chunks([=](Worker& worker, size_t begin, size_t end){
+		for (size_t i = begin; i < end; i++){
+			copy_decn(&AccDecn, &a[i]);
+			if (b){
+				copy_decn(&BDecn, &b[i]);
+			}
+			op();
+			copy_decn(&worker.out[i - begin], &AccDecn);
+		}
+		//results are only written to dst once per chunk, in input order
+		memcpy(&dst[begin], worker.out, (end - begin) * sizeof(dec80));
+	}, n, num_threads);
+}
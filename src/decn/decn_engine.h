@@ -0,0 +1,50 @@
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * decn_engine.h
+ *
+ * evaluates many independent decn calculations on a pool of threads (desktop only)
+ * each worker thread uses its own decn_ctx (registers, temporary stack, and Buf)
+ * the values are split evenly between the workers, and a worker which runs out
+ * of values steals half of the values left to another worker
+ */
+
+#ifndef SRC_DEC_DECN_ENGINE_H_
+#define SRC_DEC_DECN_ENGINE_H_
+
+#include <stddef.h>
+#include "decn.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//call job(i, arg) for each i < n, on num_threads threads (0 for one per core)
+// job() uses the decn functions as usual (AccDecn, BDecn, st_push_decn(), etc.
+// are the worker's own), e.g. to run a complete RPN program for value i
+//jobs run in any order, job() should only write the results for value i
+void decn_engine_run(void (*job)(size_t i, void* arg), void* arg, size_t n, unsigned num_threads);
+
+//dst[i] = op(a[i], b[i]) (b is NULL for functions of a single value, e.g. ln_decn),
+// on num_threads threads (0 for one per core)
+//results are identical to the single value functions, and dst may be the same
+// array as a or b
+void decn_engine_apply(void (*op)(void), dec80* dst, const dec80* a, const dec80* b,
+                       size_t n, unsigned num_threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_DEC_DECN_ENGINE_H_ */
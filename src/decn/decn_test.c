@@ -184,8 +184,8 @@ int main(void){
 	div_test(
 			"3.14", 60,
 			"-1.5", -2,
-			"-2.09333333333333334E62",
-			"-2.09333333333333334", 62
+			"-2.09333333333333333E62",
+			"-2.09333333333333333", 62
 	);
 
 	//new acc and b for divide test
@@ -200,8 +200,8 @@ int main(void){
 	div_test(
 			"1", 0,
 			"3", 0,
-			"0.333333333333333336",
-			"3.33333333333333336", -1
+			"0.333333333333333333",
+			"3.33333333333333333", -1
 	);
 
 	//small fractions >= 1/10
@@ -220,8 +220,8 @@ int main(void){
 	div_test(
 			"500", 0,
 			"99", 0,
-			"5.05050505050505055",
-			"5.05050505050505055", 0
+			"5.05050505050505051",
+			"5.05050505050505051", 0
 	);
 
 	//new acc and b for divide test
@@ -244,8 +244,8 @@ int main(void){
 	div_test(
 			"0.02", 0,
 			"0.03", 0,
-			"0.666666666666666672",
-			"0.666666666666666672", 0
+			"0.666666666666666667",
+			"0.666666666666666667", 0
 	);
 
 	//new acc for log test
@@ -21,10 +21,14 @@
 
 
 #include <string>
+#include <cstring>
 #include <random>
+#include <thread>
+#include <vector>
 #include <boost/multiprecision/mpfr.hpp>
 #include <catch2/catch.hpp>
 #include "decn.h"
+#include "decn_engine.h"
 #include "../utils.h"
 
 #include "decn_tests.h"
@@ -222,6 +226,57 @@ TEST_CASE("add"){
 	decn_to_str_complete(&AccDecn);
 	CHECK_THAT(Buf,Equals("-17000000000000000.")); //acc+b
 
+	//align by whole digit100s and an odd number of digits
+	build_dec80(          "1.23456789012345678", 0);
+	build_decn_at(&BDecn, "9.87654321098765432", -7);
+	add_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("1.23456887777777787"));
+	build_dec80(          "9.87654321098765432", -8);
+	build_decn_at(&BDecn, "-1.23456789012345678", 0);
+	add_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("-1.23456779135802468"));
+
+	//smaller operand just inside, and entirely below the 18 digit window
+	build_dec80(          "1", 0);
+	build_decn_at(&BDecn, "9", -17);
+	add_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("1.00000000000000009"));
+	build_decn_at(&BDecn, "9", -18);
+	add_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("1.00000000000000009"));
+	build_dec80(          "-1", -16000);
+	build_decn_at(&BDecn, "1", 0);
+	add_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("1."));
+	decn_to_str_complete(&BDecn);
+	CHECK_THAT(Buf, Equals("1.")); //b preserved
+	build_dec80(          "1", 16000);
+	build_decn_at(&BDecn, "-1", -16000);
+	add_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("1.E16000"));
+
+	//overflow
+	build_dec80(          "9.99", DEC80_MAX_EXP);
+	build_decn_at(&BDecn, "9.99", DEC80_MAX_EXP);
+	add_decn();
+	CHECK(decn_is_nan(&AccDecn));
+	build_dec80(          "-9.99", DEC80_MAX_EXP);
+	build_decn_at(&BDecn, "-9.99", DEC80_MAX_EXP);
+	add_decn();
+	CHECK(decn_is_nan(&AccDecn));
+	//cancellation
+	build_dec80(          "-9.99", DEC80_MAX_EXP);
+	build_decn_at(&BDecn, "9.98", DEC80_MAX_EXP);
+	add_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("-1.E16381"));
+
 	//don't negate NaN
 	set_dec80_NaN(&AccDecn);
 	negate_decn(&AccDecn);
@@ -261,7 +316,420 @@ TEST_CASE("multiply"){
 	CHECK_THAT(Buf, Equals("Error")); //acc*b
 }
 
+TEST_CASE("normalized results"){
+	//leading digits cancel
+	build_dec80("1.00000000000000001", 0);
+	build_decn_at(&BDecn, "-1", 0);
+	add_decn();
+	CHECK(decn_is_normalized(&AccDecn));
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("1.E-17"));
+
+	//0 has a 0 exponent
+	build_dec80("0", 0);
+	build_decn_at(&BDecn, "1", 20);
+	mult_decn();
+	CHECK(decn_is_zero(&AccDecn));
+	CHECK(AccDecn.exponent == 0);
+
+	//values built by hand must be normalized first
+	AccDecn.lsu[0] = digit100(1);
+	for (int i = 1; i < DEC80_NUM_LSU; i++){
+		AccDecn.lsu[i] = digit100(23);
+	}
+	set_exponent(&AccDecn, 1, 0);
+	CHECK(!decn_is_normalized(&AccDecn));
+	remove_leading_zeros(&AccDecn);
+	CHECK(decn_is_normalized(&AccDecn));
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("1.2323232323232323"));
+}
+
+static void fma_test(const char* a_str, int a_exp, const char* b_str, int b_exp,
+                     const char* c_str, int c_exp, const char* expected){
+	build_dec80(a_str, a_exp);
+	build_decn_at(&BDecn, b_str, b_exp);
+	dec80 c;
+	build_decn_at(&c, c_str, c_exp);
+	fma_decn(&c);
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals(expected)); //acc*b + c
+	//b is preserved
+	build_dec80(b_str, b_exp);
+	CHECK(AccDecn.exponent == BDecn.exponent);
+	CHECK(memcmp(AccDecn.lsu, BDecn.lsu, sizeof(AccDecn.lsu)) == 0);
+}
+
+TEST_CASE("fused multiply add"){
+#ifdef DECN_LARGE_CODE //(otherwise fma_decn() multiplies, and then adds)
+	//digits of the product below the last one aren't lost when it cancels with c
+	// (mult_decn() then add_decn() would give 2.46E-9)
+	fma_test("1.00000000123", 0, "1.00000000123", 0, "-1", 0, "2.46000000151E-9");
+	fma_test("3.33333333333333333", -1, "3", 0, "-1", 0, "-1.E-18");
+	fma_test("-1.00000000123", 0, "1.00000000123", 0, "1", 0, "-2.46000000151E-9");
+#endif
+	//signs and magnitudes
+	fma_test("2", 0, "3", 0, "-100", 0, "-94.");
+	fma_test("-2", 0, "3", 0, "5", 0, "-1.");
+	fma_test("5", 0, "2", 0, "5", 0, "15.");
+	fma_test("9", 0, "9", 0, "19", 0, "100.");
+	fma_test("1.5", 0, "2", 0, "-3", 0, "0");
+	fma_test("2", 0, "3", 0, "1", 30, "1.E30");
+	fma_test("2", 30, "3", 0, "1", 0, "6.E30");
+	//zeros
+	fma_test("0", 0, "3", 0, "-1.5", 0, "-1.5");
+	fma_test("2", 0, "3", 0, "0", 0, "6.");
+	//overflow/underflow
+	fma_test("9.99", DEC80_MAX_EXP/2, "9.99", DEC80_MAX_EXP/2, "1", 0, "Error");
+	fma_test("1", DEC80_MIN_EXP/2, "1", DEC80_MIN_EXP/2, "1", DEC80_MIN_EXP/2, "1.E-8191");
+
+	//NaN
+	dec80 c;
+	set_dec80_NaN(&c);
+	build_dec80("2", 0);
+	build_decn_at(&BDecn, "3", 0);
+	fma_decn(&c);
+	CHECK(decn_is_nan(&AccDecn));
+}
+
+#ifdef DECN_LARGE_CODE
+TEST_CASE("fused multiply add random"){
+	std::default_random_engine gen;
+	std::uniform_int_distribution<int> lsu0_distrib(10, 99);
+	std::uniform_int_distribution<int> distrib(0, 99);
+	std::uniform_int_distribution<int> sign_distrib(0,1);
+	bmp::mpfr_float::default_precision(60);
+	for (int j = 0; j < NUM_RAND_TESTS / 10; j++){
+		dec80 x[3];
+		bmp::mpfr_float actual[3];
+		for (int k = 0; k < 3; k++){
+			x[k].lsu[0] = digit100(lsu0_distrib(gen));
+			for (int i = 1; i < DEC80_NUM_LSU; i++){
+				x[k].lsu[i] = digit100(distrib(gen));
+			}
+			//keep c close to the product, so that they (partially) cancel
+			set_exponent(&x[k], (k < 2) ? distrib(gen) % 5 : distrib(gen) % 9, sign_distrib(gen));
+			copy_decn(&AccDecn, &x[k]);
+			decn_to_str_complete(&AccDecn);
+			actual[k] = bmp::mpfr_float(Buf);
+		}
+		copy_decn(&AccDecn, &x[0]);
+		copy_decn(&BDecn, &x[1]);
+		fma_decn(&x[2]);
+		decn_to_str_complete(&AccDecn);
+		CAPTURE(Buf);
+		bmp::mpfr_float calculated(Buf);
+		bmp::mpfr_float expected = actual[0] * actual[1] + actual[2];
+		CAPTURE(expected);
+		//result is truncated to 18 digits, the product is kept to 22 digits
+		CHECK(abs(calculated - expected) <= 1e-17 * abs(expected) + 1e-20 * abs(actual[0] * actual[1]));
+	}
+}
+#endif
+
 TEST_CASE("u32str corner"){
 	u32str(0, &Buf[0], 10);
 	CHECK_THAT(Buf, Equals("0"));
 }
+
+TEST_CASE("contexts"){
+	static const int NUM_THREADS = 4;
+	static const int NUM_CTX_TESTS = 2000;
+	//expected results, calculated in default context
+	std::vector<std::string> expected;
+	std::default_random_engine gen;
+	std::uniform_int_distribution<int> distrib(0, 99);
+	std::vector<dec80> inputs(NUM_CTX_TESTS);
+	for (int j = 0; j < NUM_CTX_TESTS; j++){
+		for (int i = 0; i < DEC80_NUM_LSU; i++){
+			inputs[j].lsu[i] = digit100(distrib(gen));
+		}
+		inputs[j].exponent = distrib(gen) % 5;
+		remove_leading_zeros(&inputs[j]);
+		copy_decn(&AccDecn, &inputs[j]);
+		ln_decn();
+		decn_to_str_complete(&AccDecn);
+		expected.push_back(Buf);
+	}
+
+	//each thread uses its own context
+	std::vector<std::thread> threads;
+	std::vector<int> mismatches(NUM_THREADS, 0);
+	for (int t = 0; t < NUM_THREADS; t++){
+		threads.emplace_back([&, t](){
+			decn_ctx ctx;
+			init_decn_ctx(&ctx);
+			for (int j = 0; j < NUM_CTX_TESTS; j++){
+				copy_decn(&ctx.acc, &inputs[j]);
+				apply_decn_ctx(&ctx, ln_decn);
+				use_decn_ctx(&ctx);
+				decn_to_str_complete(&ctx.acc);
+				use_decn_ctx(NULL);
+				if (expected[j] != ctx.buf){
+					mismatches[t]++;
+				}
+			}
+		});
+	}
+	for (auto& thread : threads){
+		thread.join();
+	}
+	for (int t = 0; t < NUM_THREADS; t++){
+		CAPTURE(t);
+		CHECK(mismatches[t] == 0);
+	}
+
+	//default context is not affected
+	build_dec80("7", 0);
+	decn_ctx ctx;
+	init_decn_ctx(&ctx);
+	build_decn_at(&ctx.acc, "2", 0);
+	build_decn_at(&ctx.b, "3", 0);
+	apply_decn_ctx(&ctx, add_decn);
+	decn_to_str_complete(&ctx.acc);
+	CHECK_THAT(Buf, Equals("5."));
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("7."));
+}
+
+static void check_same(const std::vector<dec80>& expected, const std::vector<dec80>& res){
+	int mismatches = 0;
+	for (size_t i = 0; i < expected.size(); i++){
+		if (expected[i].exponent != res[i].exponent ||
+		    memcmp(expected[i].lsu, res[i].lsu, DEC80_NUM_LSU) != 0){
+			mismatches++;
+		}
+	}
+	CHECK(mismatches == 0);
+}
+
+TEST_CASE("batch"){
+	static const int NUM_BATCH_TESTS = 1000; //not a multiple of the block size
+	std::default_random_engine gen;
+	std::uniform_int_distribution<int> distrib(0, 99);
+	std::vector<dec80> a(NUM_BATCH_TESTS), b(NUM_BATCH_TESTS);
+	for (int j = 0; j < NUM_BATCH_TESTS; j++){
+		for (int i = 0; i < DEC80_NUM_LSU; i++){
+			a[j].lsu[i] = digit100(distrib(gen));
+			b[j].lsu[i] = digit100(distrib(gen));
+		}
+		//include exponents which overflow when multiplied
+		set_exponent(&a[j], (distrib(gen) - 50) * 200, distrib(gen) & 1);
+		set_exponent(&b[j], (distrib(gen) - 50) * 200, distrib(gen) & 1);
+		remove_leading_zeros(&a[j]);
+		remove_leading_zeros(&b[j]);
+	}
+	set_dec80_zero(&a[1]);
+	set_dec80_zero(&b[2]);
+	set_dec80_NaN(&a[3]);
+	set_dec80_NaN(&b[4]);
+
+	//expected results, one value at a time
+	auto expected = [&](void (*op)(void), const std::vector<dec80>& x){
+		std::vector<dec80> res(NUM_BATCH_TESTS);
+		for (int j = 0; j < NUM_BATCH_TESTS; j++){
+			copy_decn(&AccDecn, &x[j]);
+			copy_decn(&BDecn, &b[j]);
+			op();
+			copy_decn(&res[j], &AccDecn);
+		}
+		return res;
+	};
+	std::vector<dec80> res(NUM_BATCH_TESTS);
+
+	SECTION("mult"){
+		mult_decn_n(res.data(), a.data(), b.data(), NUM_BATCH_TESTS);
+		check_same(expected(mult_decn, a), res);
+	}
+	SECTION("mult in place"){
+		std::vector<dec80> exp = expected(mult_decn, a);
+		mult_decn_n(a.data(), a.data(), b.data(), NUM_BATCH_TESTS);
+		check_same(exp, a);
+	}
+	SECTION("add"){
+		add_decn_n(res.data(), a.data(), b.data(), NUM_BATCH_TESTS);
+		check_same(expected(add_decn, a), res);
+	}
+	SECTION("div"){
+		div_decn_n(res.data(), a.data(), b.data(), NUM_BATCH_TESTS);
+		check_same(expected(div_decn, a), res);
+	}
+	SECTION("ln"){
+		ln_decn_n(res.data(), a.data(), NUM_BATCH_TESTS);
+		check_same(expected(ln_decn, a), res);
+	}
+	SECTION("trig"){
+		//angles in degrees (with small exponents), including 0, NaN, and the axes
+		std::vector<dec80> angles(a);
+		for (int j = 0; j < NUM_BATCH_TESTS; j++){
+			if (!decn_is_zero(&angles[j]) && !decn_is_nan(&angles[j])){
+				set_exponent(&angles[j], j % 5 - 1, angles[j].exponent < 0);
+			}
+		}
+		build_decn_at(&angles[5], "90", 0);
+		build_decn_at(&angles[6], "-270", 0);
+		build_decn_at(&angles[7], "180", 0);
+		sin_decn_n(res.data(), angles.data(), NUM_BATCH_TESTS);
+		check_same(expected(sin_decn, angles), res);
+		CHECK(decn_is_nan(&res[3]));
+		cos_decn_n(res.data(), angles.data(), NUM_BATCH_TESTS);
+		check_same(expected(cos_decn, angles), res);
+		CHECK(decn_is_nan(&res[3]));
+		tan_decn_n(res.data(), angles.data(), NUM_BATCH_TESTS);
+		check_same(expected(tan_decn, angles), res);
+		CHECK(decn_is_nan(&res[3]));
+		CHECK(decn_is_nan(&res[5])); //pole
+	}
+
+	//current context is not affected
+	build_dec80("7", 0);
+	mult_decn_n(res.data(), a.data(), b.data(), NUM_BATCH_TESTS);
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("7."));
+}
+
+//RPN program for the engine test: sqrt(x^2 + 1)
+static void engine_job(size_t i, void* arg){
+	dec80* values = static_cast<dec80*>(arg);
+	copy_decn(&AccDecn, &values[i]);
+	copy_decn(&BDecn, &values[i]);
+	mult_decn();
+	set_decn_one(&BDecn);
+	add_decn();
+	sqrt_decn();
+	copy_decn(&values[i], &AccDecn);
+}
+
+TEST_CASE("engine"){
+	static const int NUM_ENGINE_TESTS = 5000; //not a multiple of the chunk size
+	std::default_random_engine gen;
+	std::uniform_int_distribution<int> distrib(0, 99);
+	std::vector<dec80> a(NUM_ENGINE_TESTS), b(NUM_ENGINE_TESTS);
+	for (int j = 0; j < NUM_ENGINE_TESTS; j++){
+		for (int i = 0; i < DEC80_NUM_LSU; i++){
+			a[j].lsu[i] = digit100(distrib(gen));
+			b[j].lsu[i] = digit100(distrib(gen));
+		}
+		set_exponent(&a[j], distrib(gen) % 20 - 10, 0);
+		set_exponent(&b[j], distrib(gen) % 20 - 10, distrib(gen) & 1);
+		remove_leading_zeros(&a[j]);
+		remove_leading_zeros(&b[j]);
+	}
+	std::vector<dec80> res(NUM_ENGINE_TESTS);
+
+	SECTION("apply"){
+		for (unsigned threads : {1u, 3u, 0u}){
+			CAPTURE(threads);
+			decn_engine_apply(ln_decn, res.data(), a.data(), NULL, NUM_ENGINE_TESTS, threads);
+			std::vector<dec80> expected(NUM_ENGINE_TESTS);
+			ln_decn_n(expected.data(), a.data(), NUM_ENGINE_TESTS);
+			check_same(expected, res);
+
+			decn_engine_apply(div_decn, res.data(), a.data(), b.data(), NUM_ENGINE_TESTS, threads);
+			div_decn_n(expected.data(), a.data(), b.data(), NUM_ENGINE_TESTS);
+			check_same(expected, res);
+		}
+	}
+	SECTION("programs"){
+		std::vector<dec80> expected = b;
+		for (int j = 0; j < NUM_ENGINE_TESTS; j++){
+			engine_job(j, expected.data());
+		}
+		decn_engine_run(engine_job, b.data(), NUM_ENGINE_TESTS, 4);
+		check_same(expected, b);
+	}
+	SECTION("empty"){
+		decn_engine_apply(ln_decn, res.data(), a.data(), NULL, 0, 4);
+	}
+}
+
+TEST_CASE("working precision"){
+	struct prec_op {
+		const char* name;
+		void (*op)(void);
+		int min_exp, max_exp; //exponent range of the arguments
+		bool positive;
+		bool abs_err; //error relative to max(|result|, 1) (results near 0)
+	};
+	static const prec_op OPS[] = {
+		{"add", add_decn, -3, 3, false, false},
+		{"mult", mult_decn, -3, 3, false, false},
+		{"div", div_decn, -3, 3, false, false},
+		{"recip", recip_decn, -3, 3, false, false},
+		{"sqrt", sqrt_decn, -3, 3, true, false},
+		{"ln", ln_decn, -3, 3, true, true},
+		{"exp", exp_decn, -1, 1, false, false},
+		{"sin", sin_decn, 0, 2, false, true},
+		{"cos", cos_decn, 0, 2, false, true},
+		{"tan", tan_decn, 1, 1, true, false}, //(10 to 80 degrees, see below)
+		{"arctan", arctan_decn, -3, 3, false, false},
+	};
+	std::default_random_engine gen;
+	std::uniform_int_distribution<int> lsu0_distrib(10, 99);
+	std::uniform_int_distribution<int> distrib(0, 99);
+	bmp::mpfr_float::default_precision(60);
+	for (const prec_op& op : OPS){
+		for (int num_digits : {10, 12}){
+			CAPTURE(op.name, num_digits);
+			for (int j = 0; j < NUM_RAND_TESTS / 100; j++){
+				dec80 a, b, full;
+				for (int i = 0; i < DEC80_NUM_LSU; i++){
+					a.lsu[i] = digit100(distrib(gen));
+					b.lsu[i] = digit100(distrib(gen));
+				}
+				a.lsu[0] = digit100(op.op == tan_decn ? 10 + distrib(gen) % 70 : lsu0_distrib(gen));
+				b.lsu[0] = digit100(lsu0_distrib(gen));
+				set_exponent(&a, op.min_exp + distrib(gen) % (op.max_exp - op.min_exp + 1),
+				             !op.positive && (distrib(gen) & 1));
+				set_exponent(&b, distrib(gen) % 7 - 3, distrib(gen) & 1);
+
+				set_decn_precision(0);
+				copy_decn(&AccDecn, &a);
+				copy_decn(&BDecn, &b);
+				op.op();
+				copy_decn(&full, &AccDecn);
+				decn_to_str_complete(&full);
+				CAPTURE(Buf);
+				bmp::mpfr_float expected(Buf);
+
+				set_decn_precision(num_digits);
+				copy_decn(&AccDecn, &a);
+				copy_decn(&BDecn, &b);
+				op.op();
+				decn_to_str_complete(&AccDecn);
+				CAPTURE(Buf);
+				bmp::mpfr_float calculated(Buf);
+				bmp::mpfr_float scale = abs(expected);
+				if (op.abs_err && scale < 1){
+					scale = 1;
+				}
+				CHECK(abs(calculated - expected) <= pow(bmp::mpfr_float(10), -num_digits) * scale);
+
+				//2*DEC80_NUM_LSU digits is full precision
+				set_decn_precision(2 * DEC80_NUM_LSU);
+				copy_decn(&AccDecn, &a);
+				copy_decn(&BDecn, &b);
+				op.op();
+				CHECK(AccDecn.exponent == full.exponent);
+				CHECK(memcmp(AccDecn.lsu, full.lsu, DEC80_NUM_LSU) == 0);
+			}
+		}
+	}
+	set_decn_precision(0);
+
+	//the working precision is a setting of each context
+	decn_ctx ctx;
+	init_decn_ctx(&ctx);
+	set_decn_precision(10);
+	build_decn_at(&ctx.acc, "3", 0);
+	apply_decn_ctx(&ctx, recip_decn);
+	use_decn_ctx(&ctx);
+	decn_to_str_complete(&AccDecn);
+	use_decn_ctx(NULL);
+	CHECK_THAT(ctx.buf, Equals("0.333333333333333333"));
+	build_dec80("3", 0);
+	recip_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, !Equals("0.333333333333333333"));
+	set_decn_precision(0);
+}
@@ -21,8 +21,15 @@
 #ifndef DECN_TESTS_H_
 #define DECN_TESTS_H_
 
+#include "decn.h"
+
 
 static const int NUM_RAND_TESTS = 123456;
 
+//digit100 as stored in dec80.lsu[] (binary or packed BCD)
+static inline uint8_t digit100(int x){
+	return DIGIT100(x);
+}
+
 
 #endif
@@ -25,6 +25,7 @@
 #include <string>
 #include <random>
 #include <boost/multiprecision/mpfr.hpp>
+#include <boost/multiprecision/cpp_int.hpp>
 #include <catch2/catch.hpp>
 #include "decn.h"
 #include "../utils.h"
@@ -58,10 +59,31 @@ static void div_test(){ //acc / b
 	} else {
 		bmp::mpfr_float calculated(Buf);
 		bmp::mpfr_float rel_diff = abs((a_actual - calculated) / a_actual);
-		CHECK(rel_diff < 2e-17);
+		//correctly rounded: at most half a unit in the last (18th) digit
+		CHECK(rel_diff < 5.00001e-18);
 	}
 }
 
+static void recip_test(){
+	decn_to_str_complete(&AccDecn);
+	CAPTURE(Buf);
+	bmp::mpfr_float x_actual(Buf);
+	//calc result
+	recip_decn();
+	decn_to_str_complete(&AccDecn);
+	CAPTURE(Buf);
+#ifdef DECN_LARGE_CODE
+	//newton-raphson iterations should stop once converged
+	CAPTURE((int) RecipIterations);
+	CHECK(RecipIterations <= 4);
+#endif
+	//calculate actual result
+	x_actual = 1 / x_actual;
+	bmp::mpfr_float calculated(Buf);
+	bmp::mpfr_float rel_diff = abs((x_actual - calculated) / x_actual);
+	CHECK(rel_diff < 2e-17);
+}
+
 static void div_test(
 	//input
 	const char* a_str, int a_exp,
@@ -76,6 +98,35 @@ static void div_test(
 	div_test();
 }
 
+TEST_CASE("reciprocal"){
+	build_dec80("4", 0);
+	recip_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("0.25"));
+
+	const char* const xs[] = {"1", "1.09999", "1.1", "3", "-7", "9.9999", "0.5", "123456789012345678"};
+	for (const char* x: xs){
+		CAPTURE(x);
+		build_dec80(x, 0);
+		recip_test();
+	}
+}
+
+TEST_CASE("reciprocal random"){
+	std::default_random_engine gen;
+	std::uniform_int_distribution<int> lsu0_distrib(10, 99);
+	std::uniform_int_distribution<int> distrib(0, 99);
+	std::uniform_int_distribution<int> sign_distrib(0,1);
+	for (int j = 0; j < NUM_RAND_TESTS; j++){
+		AccDecn.lsu[0] = digit100(lsu0_distrib(gen));
+		for (int i = 1; i < DEC80_NUM_LSU; i++){
+			AccDecn.lsu[i] = digit100(distrib(gen));
+		}
+		set_exponent(&AccDecn, distrib(gen) - 50, sign_distrib(gen));
+		recip_test();
+	}
+}
+
 TEST_CASE("division"){
 	div_test(
 		"1", 0,
@@ -116,6 +167,44 @@ TEST_CASE("division"){
 		"0.02", 0,
 		"0.03", 0
 	);
+
+	div_test(
+		"9.99999999999999998", 0,
+		"9.99999999999999999", 0
+	);
+}
+
+TEST_CASE("division rounding"){
+	//last digit rounded
+	build_dec80("2", 0);
+	build_decn_at(&BDecn, "3", 0);
+	div_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("0.666666666666666667"));
+	//BDecn preserved
+	decn_to_str_complete(&BDecn);
+	CHECK_THAT(Buf, Equals("3."));
+
+	//last digit truncated
+	build_dec80("-1", 0);
+	build_decn_at(&BDecn, "7", 0);
+	div_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("-0.142857142857142857"));
+
+	//rounding carries through several digit100s
+	build_dec80("500", 0);
+	build_decn_at(&BDecn, "99", 0);
+	div_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("5.05050505050505051"));
+
+	//exact
+	build_dec80("1.23456789012345678", 0);
+	build_decn_at(&BDecn, "-2", -3);
+	div_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("-617.28394506172839"));
 }
 
 TEST_CASE("division random"){
@@ -123,18 +212,145 @@ TEST_CASE("division random"){
 	std::uniform_int_distribution<int> distrib(0, 99);
 	std::uniform_int_distribution<int> sign_distrib(0,1);
 	for (int j = 0; j < NUM_RAND_TESTS; j++){
-		AccDecn.lsu[0] = distrib(gen);
-		BDecn.lsu[0] = distrib(gen);
+		AccDecn.lsu[0] = digit100(distrib(gen));
+		BDecn.lsu[0] = digit100(distrib(gen));
 		for (int i = 1; i < DEC80_NUM_LSU; i++){
-			AccDecn.lsu[i] = distrib(gen);
-			BDecn.lsu[i] = distrib(gen);
+			AccDecn.lsu[i] = digit100(distrib(gen));
+			BDecn.lsu[i] = digit100(distrib(gen));
 		}
 		set_exponent(&AccDecn, distrib(gen), sign_distrib(gen));
+		remove_leading_zeros(&AccDecn);
 		set_exponent(&BDecn, distrib(gen), sign_distrib(gen));
+		remove_leading_zeros(&BDecn);
 		div_test();
 	}
 }
 
+//x == significand * 10^scale, with significand as an 18 digit integer
+static bmp::cpp_int significand_int(const dec80* x, int& scale){
+	bmp::cpp_int significand = 0;
+	for (int i = 0; i < DEC80_NUM_LSU; i++){
+		significand = significand * 100 + DIGIT100_VAL(x->lsu[i]);
+	}
+	scale = get_exponent(x) - (DEC80_NUM_LSU * 2 - 1);
+	if (x->exponent < 0){
+		significand = -significand;
+	}
+	return significand;
+}
+
+static void fmod_test(){ //acc mod b
+	//exact result, scaled to an integer
+	int a_scale, b_scale, calc_scale;
+	bmp::cpp_int a_int = significand_int(&AccDecn, a_scale);
+	bmp::cpp_int b_int = significand_int(&BDecn, b_scale);
+	decn_to_str_complete(&AccDecn);
+	CAPTURE(Buf);
+	decn_to_str_complete(&BDecn);
+	CAPTURE(Buf);
+	//calc result
+	fmod_decn();
+	decn_to_str_complete(&AccDecn);
+	CAPTURE(Buf);  // acc mod b
+	if (b_int == 0){
+		CHECK(decn_is_nan(&AccDecn));
+		return;
+	}
+	bmp::cpp_int calc_int = significand_int(&AccDecn, calc_scale);
+	int scale = std::min(std::min(a_scale, b_scale), calc_scale);
+	a_int *= pow(bmp::cpp_int(10), a_scale - scale);
+	b_int *= pow(bmp::cpp_int(10), b_scale - scale);
+	calc_int *= pow(bmp::cpp_int(10), calc_scale - scale);
+	//cpp_int % truncates, like fmod()
+	bmp::cpp_int expected = a_int % b_int;
+	CHECK(calc_int == expected);
+}
+
+static void fmod_test(
+	//input
+	const char* a_str, int a_exp,
+	const char* b_str, int b_exp
+)
+{
+	CAPTURE(a_str); CAPTURE(a_exp);
+	CAPTURE(b_str); CAPTURE(b_exp);
+	build_dec80(a_str, a_exp);
+	build_decn_at(&BDecn,   b_str, b_exp);
+	fmod_test();
+}
+
+TEST_CASE("fmod"){
+	build_dec80("10", 0);
+	build_decn_at(&BDecn, "3", 0);
+	fmod_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("1."));
+	//BDecn preserved
+	decn_to_str_complete(&BDecn);
+	CHECK_THAT(Buf, Equals("3."));
+
+	//sign of dividend
+	build_dec80("-5.5", 0);
+	build_decn_at(&BDecn, "-2", 0);
+	fmod_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("-1.5"));
+
+	//10^k mod 360 == 280 for k >= 3
+	build_dec80("1", 100);
+	build_decn_at(&BDecn, "360", 0);
+	fmod_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("280."));
+
+	//10^16000 mod 7 == 3^(16000 mod 6) mod 7 == 4
+	build_dec80("1", 16000);
+	build_decn_at(&BDecn, "7", 0);
+	fmod_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("4."));
+
+	fmod_test("6", 0, "3", 0);
+	fmod_test("1", 0, "3", 0);
+	fmod_test("-10", 0, "3", 0);
+	fmod_test("10", 0, "-3", 0);
+	fmod_test("1", 0, "0", 0);
+	fmod_test("0", 0, "3", 0);
+	fmod_test("3.14159265358979324", 0, "1", -5);
+	fmod_test("999999999999999999", 0, "1.00000000000000001", 0);
+	fmod_test("123456789012345678", 1000, "987654321098765432", 0);
+	fmod_test("-123456789012345678", 16383, "3.6", -16000);
+	fmod_test("2", -16000, "3", 0);
+}
+
+TEST_CASE("fmod random"){
+	std::default_random_engine gen;
+	std::uniform_int_distribution<int> distrib(0, 99);
+	std::uniform_int_distribution<int> exp_distrib(-DEC80_MAX_EXP, DEC80_MAX_EXP);
+	std::uniform_int_distribution<int> sign_distrib(0,1);
+	for (int j = 0; j < NUM_RAND_TESTS / 16; j++){
+		AccDecn.lsu[0] = digit100(distrib(gen));
+		BDecn.lsu[0] = digit100(distrib(gen));
+		for (int i = 1; i < DEC80_NUM_LSU; i++){
+			AccDecn.lsu[i] = digit100(distrib(gen));
+			BDecn.lsu[i] = digit100(distrib(gen));
+		}
+		if (j & 1){
+			//exponent differences for squaring
+			set_exponent(&AccDecn, exp_distrib(gen) / 2 + DEC80_MAX_EXP / 2, sign_distrib(gen));
+			remove_leading_zeros(&AccDecn);
+			set_exponent(&BDecn, distrib(gen) - 50, sign_distrib(gen));
+			remove_leading_zeros(&BDecn);
+		} else {
+			set_exponent(&AccDecn, distrib(gen), sign_distrib(gen));
+			remove_leading_zeros(&AccDecn);
+			set_exponent(&BDecn, distrib(gen), sign_distrib(gen));
+			remove_leading_zeros(&BDecn);
+		}
+		fmod_test();
+	}
+}
+
 static void sqrt_test(){
 	decn_to_str_complete(&AccDecn);
 	CAPTURE(Buf);
@@ -159,7 +375,8 @@ static void sqrt_test(){
 		CAPTURE(x_actual);
 		bmp::mpfr_float calculated(Buf);
 		bmp::mpfr_float rel_diff = abs((x_actual - calculated) / x_actual);
-		CHECK(rel_diff < 2e-17);
+		//correctly rounded: at most half a unit in the last (18th) digit
+		CHECK(rel_diff < 5.00001e-18);
 	}
 }
 
@@ -182,6 +399,35 @@ TEST_CASE("sqrt"){
 	sqrt_test("1.5", 0);
 	sqrt_test("9", 99);
 	sqrt_test("123", 12345);
+	sqrt_test("99.9999999999999999", 0);
+	sqrt_test("999999999999999999", 0);
+}
+
+TEST_CASE("sqrt exact"){
+	const char* const squares[][2] = {
+		{"4", "2."},
+		{"144", "12."},
+		{"0.0625", "0.25"},
+		{"1.5129", "1.23"},
+		{"111111110888888889", "333333333."},
+		{"1", "1."},
+	};
+	for (auto& sq: squares){
+		CAPTURE(sq[0]);
+		build_dec80(sq[0], 0);
+		sqrt_decn();
+		decn_to_str_complete(&AccDecn);
+		CHECK_THAT(Buf, Equals(sq[1]));
+	}
+	//largest significand doesn't round up to 10
+	build_dec80("99.9999999999999999", 0);
+	sqrt_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("9.99999999999999999"));
+	build_dec80("9.99999999999999999", 0);
+	sqrt_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("3.16227766016837933"));
 }
 
 TEST_CASE("sqrt random"){
@@ -191,10 +437,11 @@ TEST_CASE("sqrt random"){
 	std::uniform_int_distribution<int> sign_distrib(0,1);
 	for (int j = 0; j < NUM_RAND_TESTS; j++){
 		for (int i = 0; i < DEC80_NUM_LSU; i++){
-			AccDecn.lsu[i] = distribution(generator);
+			AccDecn.lsu[i] = digit100(distribution(generator));
 		}
 		int sign = sign_distrib(generator);
 		set_exponent(&AccDecn, exp_distrib(generator), sign);
+		remove_leading_zeros(&AccDecn);
 		sqrt_test();
 	}
 }
@@ -73,19 +73,19 @@ static void log_test_(bool base10, double epsilon){
 static void log_test(bool base10=false){
 	//check if near 1.0
 	remove_leading_zeros(&AccDecn);
-	double lsu0 = AccDecn.lsu[0];
+	double lsu0 = DIGIT100_VAL(AccDecn.lsu[0]);
 	int exp = get_exponent(&AccDecn);
 	if (exp == -1){
 		lsu0 /= (double) 10;
-		lsu0 += (double) AccDecn.lsu[1] / (10*100);
-		lsu0 += (double) AccDecn.lsu[2] / (10*100*100);
-		lsu0 += (double) AccDecn.lsu[3] / (10*100*100*100);
+		lsu0 += (double) DIGIT100_VAL(AccDecn.lsu[1]) / (10*100);
+		lsu0 += (double) DIGIT100_VAL(AccDecn.lsu[2]) / (10*100*100);
+		lsu0 += (double) DIGIT100_VAL(AccDecn.lsu[3]) / (10*100*100*100);
 	} else if (exp == 0){
-		lsu0 += (double) AccDecn.lsu[1] / 100;
-		lsu0 += (double) AccDecn.lsu[2] / (100*100);
-		lsu0 += (double) AccDecn.lsu[3] / (100*100*100);
+		lsu0 += (double) DIGIT100_VAL(AccDecn.lsu[1]) / 100;
+		lsu0 += (double) DIGIT100_VAL(AccDecn.lsu[2]) / (100*100);
+		lsu0 += (double) DIGIT100_VAL(AccDecn.lsu[3]) / (100*100*100);
 	}
-	CAPTURE((int) AccDecn.lsu[0]); CAPTURE((int) AccDecn.lsu[1]);
+	CAPTURE((int) DIGIT100_VAL(AccDecn.lsu[0])); CAPTURE((int) DIGIT100_VAL(AccDecn.lsu[1]));
 	CAPTURE(exp);
 	CAPTURE(lsu0);
 	if (exp == 0 || exp == -1){
@@ -147,6 +147,32 @@ TEST_CASE("log"){
 	log_test("1.5", 0, true);
 	log_test("9", 99);
 	log_test("123", 12345);
+	//near 1
+	log_test("1.0000000001", 0);
+	log_test("0.9999999999", 0);
+	log_test("1.0000000001", 0, true);
+
+	//exactly 0
+	build_dec80("1", 0);
+	ln_decn();
+	CHECK(decn_is_zero(&AccDecn));
+
+	//integer part is exact
+	build_dec80("1", 0);
+	log10_decn();
+	CHECK(decn_is_zero(&AccDecn));
+	build_dec80("1", 6);
+	log10_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("6."));
+	build_dec80("1", -300);
+	log10_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("-300."));
+	build_dec80("1", DEC80_MAX_EXP);
+	log10_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("16383."));
 }
 
 TEST_CASE("log random"){
@@ -156,7 +182,7 @@ TEST_CASE("log random"){
 	std::uniform_int_distribution<int> sign_distrib(0,1);
 	for (int j = 0; j < NUM_RAND_TESTS; j++){
 		for (int i = 0; i < DEC80_NUM_LSU; i++){
-			AccDecn.lsu[i] = distrib(gen);
+			AccDecn.lsu[i] = digit100(distrib(gen));
 		}
 		int exp = exp_distrib(gen);
 		set_exponent(&AccDecn, exp, 0);
@@ -172,9 +198,9 @@ static void log_test_near1(int lsu0_low, int lsu0_high, int exp){
 	std::uniform_int_distribution<int> exp_distrib(-99,99);
 	std::uniform_int_distribution<int> sign_distrib(0,1);
 	for (int j = 0; j < NUM_RAND_TESTS; j++){
-		AccDecn.lsu[0] = lsu0_distrib(gen);
+		AccDecn.lsu[0] = digit100(lsu0_distrib(gen));
 		for (int i = 1; i < DEC80_NUM_LSU; i++){
-			AccDecn.lsu[i] = distrib(gen);
+			AccDecn.lsu[i] = digit100(distrib(gen));
 		}
 		set_exponent(&AccDecn, exp, 0);
 		int base10 = sign_distrib(gen);
@@ -215,7 +241,7 @@ static void exp_test_(bool base10, double epsilon){
 	//calculate actual result
 	bmp::mpfr_float calculated(Buf);
 	if (base10){
-		x_actual *= log(10);
+		x_actual *= log(bmp::mpfr_float(10)); //not log(double)
 	}
 	x_actual = exp(x_actual);
 	CAPTURE(x_actual);
@@ -227,13 +253,13 @@ static void exp_test(bool base10=false){
 	double x;
 	int exp = get_exponent(&AccDecn);
 	if (exp == 1){
-		x = AccDecn.lsu[0];
-		x += (double) AccDecn.lsu[1] / 100;
+		x = DIGIT100_VAL(AccDecn.lsu[0]);
+		x += (double) DIGIT100_VAL(AccDecn.lsu[1]) / 100;
 	} else if (exp == 2){
-		x = (double) AccDecn.lsu[0] * 10;
-		x += (double) AccDecn.lsu[1] / 10;
+		x = (double) DIGIT100_VAL(AccDecn.lsu[0]) * 10;
+		x += (double) DIGIT100_VAL(AccDecn.lsu[1]) / 10;
 	}
-	CAPTURE((int) AccDecn.lsu[0]); CAPTURE((int) AccDecn.lsu[1]);
+	CAPTURE((int) DIGIT100_VAL(AccDecn.lsu[0])); CAPTURE((int) DIGIT100_VAL(AccDecn.lsu[1]));
 	CAPTURE(exp);
 	CAPTURE(x);
 	double epsilon;
@@ -293,6 +319,20 @@ TEST_CASE("exp"){
 	exp_test("230.2", 0);//, 6e-15);
 	exp_test("-230", 0);//, 6e-15);
 	exp_test("294.69999999", 0);//, 8e-15);
+	exp_test("294.73", 0); //just below 10^128
+	exp_test("2.30258509299404568", 0); //ln(10), remainder after range reduction close to 0 or ln(10)
+	exp_test("4.60517018598809137", 0); //2*ln(10)
+
+	//out of range
+	build_dec80("294.74", 0);
+	exp_decn();
+	CHECK(decn_is_nan(&AccDecn));
+	build_dec80("-294.74", 0);
+	exp_decn();
+	CHECK(decn_is_nan(&AccDecn));
+	build_dec80("1", 4);
+	exp_decn();
+	CHECK(decn_is_nan(&AccDecn));
 
 	//do not operate on NaN
 	set_dec80_NaN(&AccDecn);
@@ -314,6 +354,25 @@ TEST_CASE("exp10"){
 	exp10_test("99.999999", 0);//, 2e-14);
 }
 
+static void exp10_exact_test(const char* x_str, int x_exp, const char* expected){
+	CAPTURE(x_str); CAPTURE(x_exp);
+	build_dec80(x_str, x_exp);
+	exp10_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals(expected));
+}
+
+TEST_CASE("exp10 integer"){
+	//x == k*ln(10) must not leave a remainder of ln(10)
+	exp10_exact_test("1", 0, "10.");
+	exp10_exact_test("2", 0, "100.");
+	exp10_exact_test("10", 0, "10000000000.");
+	exp10_exact_test("0", 0, "1.");
+	exp10_exact_test("127", 0, "1.E127");
+	exp10_exact_test("-2", 0, "0.01");
+	exp10_exact_test("-127", 0, "1.E-127");
+}
+
 static void test_exp_random(int exp_distrib_low){
 	std::default_random_engine gen;
 	std::uniform_int_distribution<int> distrib(0, 99);
@@ -325,14 +384,15 @@ static void test_exp_random(int exp_distrib_low){
 		int sign = sign_distrib(gen);
 		if (exp == 2) {
 			//limit x to approximately +/- 230
-			AccDecn.lsu[0] = lsu0_high_distrib(gen);
+			AccDecn.lsu[0] = digit100(lsu0_high_distrib(gen));
 		} else {
-			AccDecn.lsu[0] = distrib(gen);
+			AccDecn.lsu[0] = digit100(distrib(gen));
 		}
 		for (int i = 1; i < DEC80_NUM_LSU; i++){
-			AccDecn.lsu[i] = distrib(gen);
+			AccDecn.lsu[i] = digit100(distrib(gen));
 		}
 		set_exponent(&AccDecn, exp, sign);
+		remove_leading_zeros(&AccDecn);
 		exp_test();
 	}
 }
@@ -437,6 +497,47 @@ TEST_CASE("power"){
 	);
 }
 
+static void pow_exact_test(
+	const char* a_str, int a_exp,
+	const char* b_str, int b_exp,
+	const char* expected
+)
+{
+	CAPTURE(a_str); CAPTURE(a_exp);
+	CAPTURE(b_str); CAPTURE(b_exp);
+	build_decn_at(&BDecn,   b_str, b_exp);
+	build_dec80(a_str, a_exp);
+	pow_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals(expected));
+}
+
+TEST_CASE("power integer"){
+	//repeated squaring
+	pow_exact_test("2", 0, "10", 0, "1024.");
+	pow_exact_test("1.05", 0, "12", 0, "1.79585632602212915");
+	pow_exact_test("2", 0, "-10", 0, "9.765625E-4");
+	pow_exact_test("7", 0, "1", 0, "7.");
+	pow_exact_test("1.5", 0, "2", 1, "3325.25673007965087");
+	//negative bases
+	pow_exact_test("-2", 0, "3", 0, "-8.");
+	pow_exact_test("-2", 0, "-3", 0, "-0.125");
+	pow_exact_test("-3", 0, "4", 0, "81.");
+	pow_exact_test("10", 0, "2", 0, "100.");
+	//larger integer exponents use ln() and exp(), but keep the sign
+	pow_exact_test("-1", 0, "1001", 0, "-1.");
+	pow_exact_test("-1", 0, "1", 20, "1.");
+	//non-integer exponent of a negative base is an error
+	build_decn_at(&BDecn, "2.5", 0);
+	build_dec80("-1.5", 0);
+	pow_decn();
+	CHECK(decn_is_nan(&AccDecn));
+
+	pow_test("3", 0, "127", 0);
+	pow_test("3", 0, "128", 0);
+	pow_test("0.999", 0, "-127", 0);
+}
+
 static void power_test(int lsu0_low, int lsu0_high, int exp_low=-99, int exp_high=99){
 	std::default_random_engine gen;
 	std::uniform_int_distribution<int> lsu0_distrib(lsu0_low, lsu0_high);
@@ -444,12 +545,13 @@ static void power_test(int lsu0_low, int lsu0_high, int exp_low=-99, int exp_hig
 	std::uniform_int_distribution<int> exp_distrib(exp_low, exp_high);
 	std::uniform_int_distribution<int> sign_distrib(0,1);
 	for (int j = 0; j < NUM_RAND_TESTS; j++){
-		AccDecn.lsu[0] = lsu0_distrib(gen);
+		AccDecn.lsu[0] = digit100(lsu0_distrib(gen));
 		for (int i = 1; i < DEC80_NUM_LSU; i++){
-			AccDecn.lsu[i] = distrib(gen);
-			BDecn.lsu[i] = distrib(gen);
+			AccDecn.lsu[i] = digit100(distrib(gen));
+			BDecn.lsu[i] = digit100(distrib(gen));
 		}
 		set_exponent(&AccDecn, exp_distrib(gen), 0);
+		remove_leading_zeros(&AccDecn);
 		//generate exponent for b to minimize chance of a^b overflowing:
 		// a^b <= 1e100
 		// b*log(a) <= log(1e100) = 100
@@ -475,6 +577,7 @@ static void power_test(int lsu0_low, int lsu0_high, int exp_low=-99, int exp_hig
 		CAPTURE(b_exponent);
 		int b_neg = sign_distrib(gen);
 		set_exponent(&BDecn, b_exponent, b_neg);
+		remove_leading_zeros(&BDecn);
 		pow_test();
 	}
 }
@@ -13,6 +13,7 @@
 
 
 #include <string>
+#include <cmath>
 #include <boost/multiprecision/mpfr.hpp>
 #include <catch2/catch.hpp>
 #include "decn.h"
@@ -41,24 +42,34 @@ static void trig_test(void (*operation)(void), bmp::mpfr_float (*mpfr_operation)
 	a_actual = mpfr_operation(a_actual);
 	CAPTURE(a_actual);
 
+	if (decn_is_nan(&AccDecn)){
+		//check that NaN is from result of tan() at a pole
+		CHECK(abs(a_actual) > 1e15);
+		return;
+	}
 	bmp::mpfr_float calculated(Buf);
-	if (rtol >= 0) {
-		bmp::mpfr_float rel_diff = abs((a_actual - calculated) / a_actual);
-		CHECK(rel_diff < rtol);
-	} else {
-		bmp::mpfr_float diff = abs(a_actual - calculated);
+	bmp::mpfr_float diff = abs(a_actual - calculated);
+	CAPTURE(diff);
+	if (diff < atol){
 		CHECK(diff < atol);
+	} else {
+		bmp::mpfr_float rel_diff = abs(diff / a_actual);
+		CHECK(rel_diff < rtol);
 	}
 }
 
+//default tolerances: relative tolerance, or absolute tolerance for results near 0
+static const double TRIG_RTOL = 1e-15;
+static const double TRIG_ATOL = 1e-16;
+
 
-static void sin_test(double rtol=6e-3, double atol=1e-3)
+static void sin_test(double rtol=TRIG_RTOL, double atol=TRIG_ATOL)
 {
 	CAPTURE("sin test");
 	trig_test(sin_decn, [](bmp::mpfr_float x) -> bmp::mpfr_float {return sin(x * mPI / 180);}, rtol, atol);
 }
 
-static void sin_test(const char* a_str, int a_exp, double rtol=5e-3, double atol=1e-3)
+static void sin_test(const char* a_str, int a_exp, double rtol=TRIG_RTOL, double atol=TRIG_ATOL)
 {
 	CAPTURE(a_str); CAPTURE(a_exp);
 	build_dec80(a_str, a_exp);
@@ -66,13 +77,13 @@ static void sin_test(const char* a_str, int a_exp, double rtol=5e-3, double atol
 }
 
 
-static void cos_test(double rtol=6e-3, double atol=1e-3)
+static void cos_test(double rtol=TRIG_RTOL, double atol=TRIG_ATOL)
 {
 	CAPTURE("cos test");
 	trig_test(cos_decn, [](bmp::mpfr_float x) -> bmp::mpfr_float {return cos(x * mPI / 180);}, rtol, atol);
 }
 
-static void cos_test(const char* a_str, int a_exp, double rtol=5e-3, double atol=1e-3)
+static void cos_test(const char* a_str, int a_exp, double rtol=TRIG_RTOL, double atol=TRIG_ATOL)
 {
 	CAPTURE(a_str); CAPTURE(a_exp);
 	build_dec80(a_str, a_exp);
@@ -80,12 +91,12 @@ static void cos_test(const char* a_str, int a_exp, double rtol=5e-3, double atol
 }
 
 
-static void tan_test(double rtol=5e-3, double atol=1e-3)
+static void tan_test(double rtol=TRIG_RTOL, double atol=TRIG_ATOL)
 {
 	trig_test(tan_decn, [](bmp::mpfr_float x) -> bmp::mpfr_float {return tan(x * mPI / 180);}, rtol, atol);
 }
 
-static void tan_test(const char* a_str, int a_exp, double rtol=5e-3, double atol=1e-3)
+static void tan_test(const char* a_str, int a_exp, double rtol=TRIG_RTOL, double atol=TRIG_ATOL)
 {
 	CAPTURE(a_str); CAPTURE(a_exp);
 	build_dec80(a_str, a_exp);
@@ -93,12 +104,12 @@ static void tan_test(const char* a_str, int a_exp, double rtol=5e-3, double atol
 }
 
 
-static void atan_test(double rtol=5e-3, double atol=1e-3)
+static void atan_test(double rtol=TRIG_RTOL, double atol=TRIG_ATOL)
 {
 	trig_test(arctan_decn, [](bmp::mpfr_float x) -> bmp::mpfr_float {return atan(x)*180/mPI;}, rtol, atol);
 }
 
-static void atan_test(const char* a_str, int a_exp, double rtol=5e-3, double atol=1e-3)
+static void atan_test(const char* a_str, int a_exp, double rtol=TRIG_RTOL, double atol=TRIG_ATOL)
 {
 	CAPTURE(a_str); CAPTURE(a_exp);
 	build_dec80(a_str, a_exp);
@@ -106,12 +117,12 @@ static void atan_test(const char* a_str, int a_exp, double rtol=5e-3, double ato
 }
 
 
-static void asin_test(double rtol=5e-3, double atol=1e-3)
+static void asin_test(double rtol=TRIG_RTOL, double atol=TRIG_ATOL)
 {
 	trig_test(arcsin_decn, [](bmp::mpfr_float x) -> bmp::mpfr_float {return asin(x)*180/mPI;}, rtol, atol);
 }
 
-static void asin_test(const char* a_str, int a_exp, double rtol=5e-3, double atol=1e-3)
+static void asin_test(const char* a_str, int a_exp, double rtol=TRIG_RTOL, double atol=TRIG_ATOL)
 {
 	CAPTURE(a_str); CAPTURE(a_exp);
 	build_dec80(a_str, a_exp);
@@ -119,12 +130,12 @@ static void asin_test(const char* a_str, int a_exp, double rtol=5e-3, double ato
 }
 
 
-static void acos_test(double rtol=5e-3, double atol=1e-3)
+static void acos_test(double rtol=TRIG_RTOL, double atol=TRIG_ATOL)
 {
 	trig_test(arccos_decn, [](bmp::mpfr_float x) -> bmp::mpfr_float {return acos(x)*180/mPI;}, rtol, atol);
 }
 
-static void acos_test(const char* a_str, int a_exp, double rtol=5e-3, double atol=1e-3)
+static void acos_test(const char* a_str, int a_exp, double rtol=TRIG_RTOL, double atol=TRIG_ATOL)
 {
 	CAPTURE(a_str); CAPTURE(a_exp);
 	build_dec80(a_str, a_exp);
@@ -137,13 +148,28 @@ static void acos_test(const char* a_str, int a_exp, double rtol=5e-3, double ato
 // const char * const pi_quarter = ".7853981633974483096";
 
 
+TEST_CASE("degrees radians"){
+	build_dec80("180", 0);
+	to_radian_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("3.14159265358979324"));
+	build_dec80("1", 0);
+	to_radian_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("0.0174532925199432958"));
+	pi_decn();
+	to_degree_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals("180."));
+}
+
 TEST_CASE("sin") {
-	sin_test("0.1", 0, 0.2);
-	sin_test("0.0", 0, -1);
-	sin_test("1.5", 0, 0.02);
-	sin_test("2.0", 0, 0.02);
-	sin_test("2.5", 0, 0.02);
-	sin_test("3.0", 0, 0.02);
+	sin_test("0.1", 0);
+	sin_test("0.0", 0);
+	sin_test("1.5", 0);
+	sin_test("2.0", 0);
+	sin_test("2.5", 0);
+	sin_test("3.0", 0);
 	sin_test("10", 0);
 	sin_test("20", 0);
 	sin_test("30", 0);
@@ -155,24 +181,24 @@ TEST_CASE("sin") {
 	sin_test("240", 0);
 	sin_test("280", 0);
 	sin_test("320", 0);
-	sin_test("359", 0, 0.02);
-	sin_test("360", 0, -1, 0.001);
-	sin_test("361", 0, 0.02);
+	sin_test("359", 0);
+	sin_test("360", 0);
+	sin_test("361", 0);
 	sin_test("400", 0);
 // 	sin_test(pi, 0, -1);
 // 	sin_test(pi_quarter, 0);
 // 	sin_test(pi_halved, 0);
 // 	sin_test(pi_threequarters, 0);
-	sin_test("180.0", 0, -1);
+	sin_test("180.0", 0);
 	sin_test("45.0", 0);
 	sin_test("90.0", 0);
 	sin_test("135.0", 0);
 	sin_test("1000.0", 0);
-	sin_test("-0.5", 0, 0.2);
-	sin_test("-1.5", 0, 0.02);
-	sin_test("-2.0", 0, 0.02);
-	sin_test("-2.5", 0, 0.02);
-	sin_test("-3.0", 0, 0.02);
+	sin_test("-0.5", 0);
+	sin_test("-1.5", 0);
+	sin_test("-2.0", 0);
+	sin_test("-2.5", 0);
+	sin_test("-3.0", 0);
 	sin_test("-9.0", 0);
 	sin_test("-18.0", 0);
 	sin_test("-27.0", 0);
@@ -186,17 +212,40 @@ TEST_CASE("sin") {
 	sin_test("-240", 0);
 	sin_test("-280", 0);
 	sin_test("-320", 0);
-	sin_test("-360", 0, -1, 0.001);
+	sin_test("-360", 0);
 	sin_test("-400", 0);
 }
 
+//sin(angle) should equal sin(reduced) exactly, since the angle is reduced exactly
+static void sin_reduced_test(const char* a_str, int a_exp, const char* reduced_str){
+	CAPTURE(a_str); CAPTURE(a_exp);
+	build_dec80(reduced_str, 0);
+	sin_decn();
+	decn_to_str_complete(&AccDecn);
+	std::string expected(Buf);
+	build_dec80(a_str, a_exp);
+	sin_decn();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals(expected));
+}
+
+TEST_CASE("sin huge angles") {
+	//10^k mod 360 == 280 for k >= 3
+	sin_reduced_test("1", 100, "280");
+	sin_reduced_test("1", 16383, "280");
+	sin_reduced_test("-1", 5000, "-280");
+	sin_reduced_test("1.0000000000000001", 20, "200");
+	sin_reduced_test("3.6", 16000, "0");
+	sin_reduced_test("123456789012345678", 0, "198");
+}
+
 TEST_CASE("cos") {
-	cos_test("0.1", 0, 0.2);
-	cos_test("0.0", 0, -1);
-	cos_test("1.5", 0, 0.02);
-	cos_test("2.0", 0, 0.02);
-	cos_test("2.5", 0, 0.02);
-	cos_test("3.0", 0, 0.02);
+	cos_test("0.1", 0);
+	cos_test("0.0", 0);
+	cos_test("1.5", 0);
+	cos_test("2.0", 0);
+	cos_test("2.5", 0);
+	cos_test("3.0", 0);
 	cos_test("10", 0);
 	cos_test("20", 0);
 	cos_test("30", 0);
@@ -206,51 +255,51 @@ TEST_CASE("cos") {
 	cos_test("160", 0);
 	cos_test("200", 0);
 	cos_test("240", 0);
-	cos_test("280", 0, 0.006);
+	cos_test("280", 0);
 	cos_test("320", 0);
-	cos_test("359", 0, 0.02);
-	cos_test("360", 0, -1, 0.001);
-	cos_test("361", 0, 0.02);
+	cos_test("359", 0);
+	cos_test("360", 0);
+	cos_test("361", 0);
 	cos_test("400", 0);
 // 	cos_test(pi, 0, -1);
 // 	cos_test(pi_quarter, 0);
 // 	cos_test(pi_halved, 0);
 // 	cos_test(pi_threequarters, 0);
-	cos_test("180.0", 0, -1);
+	cos_test("180.0", 0);
 	cos_test("45.0", 0);
-	cos_test("90.0", 0, -1, 0.001);
+	cos_test("90.0", 0);
 	cos_test("135.0", 0);
-	cos_test("1000.0", 0, 0.006);
-	cos_test("-0.5", 0, 0.2);
-	cos_test("-1.5", 0, 0.02);
-	cos_test("-2.0", 0, 0.02);
-	cos_test("-2.5", 0, 0.02);
-	cos_test("-3.0", 0, 0.02);
+	cos_test("1000.0", 0);
+	cos_test("-0.5", 0);
+	cos_test("-1.5", 0);
+	cos_test("-2.0", 0);
+	cos_test("-2.5", 0);
+	cos_test("-3.0", 0);
 	cos_test("-9.0", 0);
 	cos_test("-18.0", 0);
 	cos_test("-27.0", 0);
 	cos_test("-1000.0", 0);
 	cos_test("-30", 0);
 	cos_test("-40", 0);
-	cos_test("-80", 0, 0.006);
+	cos_test("-80", 0);
 	cos_test("-120", 0);
 	cos_test("-160", 0);
 	cos_test("-200", 0);
 	cos_test("-240", 0);
 	cos_test("-280", 0);
 	cos_test("-320", 0);
-	cos_test("-360", 0, -1, 0.001);
+	cos_test("-360", 0);
 	cos_test("-400", 0);
 }
 
 
 TEST_CASE("tan") {
-	tan_test("0.1", 0, 0.2);
-	tan_test("0.0", 0, -1);
-	tan_test("1.5", 0, 0.02);
-	tan_test("2.0", 0, 0.02);
-	tan_test("2.5", 0, 0.02);
-	tan_test("3.0", 0, 0.02);
+	tan_test("0.1", 0);
+	tan_test("0.0", 0);
+	tan_test("1.5", 0);
+	tan_test("2.0", 0);
+	tan_test("2.5", 0);
+	tan_test("3.0", 0);
 	tan_test("10", 0);
 	tan_test("20", 0);
 	tan_test("30", 0);
@@ -260,46 +309,46 @@ TEST_CASE("tan") {
 	tan_test("160", 0);
 	tan_test("200", 0);
 	tan_test("240", 0);
-	tan_test("280", 0, 0.006);
+	tan_test("280", 0);
 	tan_test("320", 0);
-	tan_test("359", 0, 0.02);
-	tan_test("360", 0, -1, 0.001);
-	tan_test("361", 0, 0.02);
+	tan_test("359", 0);
+	tan_test("360", 0);
+	tan_test("361", 0);
 	tan_test("400", 0);
 // 	tan_test(pi, 0, -1);
 // 	tan_test(pi_quarter, 0);
 // 	tan_test(pi_halved, 0);
 // 	tan_test(pi_threequarters, 0);
-	tan_test("180.0", 0, -1);
+	tan_test("180.0", 0);
 	tan_test("45.0", 0);
-	tan_test("90.0", 0, 2);
+	tan_test("90.0", 0); //pole: returns Error
 	tan_test("135.0", 0);
-	tan_test("1000.0", 0, 0.006);
-	tan_test("-0.5", 0, 0.2);
-	tan_test("-1.5", 0, 0.02);
-	tan_test("-2.0", 0, 0.02);
-	tan_test("-2.5", 0, 0.02);
-	tan_test("-3.0", 0, 0.02);
+	tan_test("1000.0", 0);
+	tan_test("-0.5", 0);
+	tan_test("-1.5", 0);
+	tan_test("-2.0", 0);
+	tan_test("-2.5", 0);
+	tan_test("-3.0", 0);
 	tan_test("-9.0", 0);
 	tan_test("-18.0", 0);
 	tan_test("-27.0", 0);
 	tan_test("-1000.0", 0);
 	tan_test("-30", 0);
 	tan_test("-40", 0);
-	tan_test("-80", 0, 0.006);
+	tan_test("-80", 0);
 	tan_test("-120", 0);
 	tan_test("-160", 0);
 	tan_test("-200", 0);
 	tan_test("-240", 0);
 	tan_test("-280", 0);
 	tan_test("-320", 0);
-	tan_test("-360", 0, -1, 0.001);
+	tan_test("-360", 0);
 	tan_test("-400", 0);
 }
 
 TEST_CASE("arctan") {
-	atan_test("0.001",  0, -1, 0.06);
-	atan_test("-0.001", 0, -1, 0.06);
+	atan_test("0.001", 0);
+	atan_test("-0.001", 0);
 	atan_test("0.7", 0);
 	atan_test("-0.7", 0);
 	atan_test("0.1", 0);
@@ -310,16 +359,16 @@ TEST_CASE("arctan") {
 	atan_test("-2.0", 0);
 	atan_test("3.0", 0);
 	atan_test("-3.0", 0);
-	atan_test("0", 0, -1, 0.06);
+	atan_test("0", 0);
 }
 
 TEST_CASE("arcsin") {
-	asin_test("0.001",  0, -1, 0.06);
-	asin_test("-0.001", 0, -1, 0.06);
+	asin_test("0.001", 0);
+	asin_test("-0.001", 0);
 	asin_test("0.7", 0);
 	asin_test("-0.7", 0);
-	asin_test("0.1", 0, 1e-2);
-	asin_test("-0.1", 0, 1e-2);
+	asin_test("0.1", 0);
+	asin_test("-0.1", 0);
 	asin_test("0.9", 0);
 	asin_test("-0.9", 0);
 }
@@ -335,201 +384,217 @@ TEST_CASE("arccos") {
 	acos_test("-0.9", 0);
 }
 
+TEST_CASE("trig NaN") {
+	void (*const ops[])(void) = {
+		sin_decn, cos_decn, tan_decn, arctan_decn, arcsin_decn, arccos_decn,
+	};
+	for (auto op : ops){
+		set_dec80_NaN(&AccDecn);
+		op();
+		CHECK(decn_is_nan(&AccDecn));
+	}
+}
 
-static const int NUM_RAND_TRIG_TESTS = 4321; //trig tests are slow
+static void trig_exact_test(void (*operation)(void), const char* a_str, int a_exp, const char* expected)
+{
+	CAPTURE(a_str); CAPTURE(a_exp);
+	build_dec80(a_str, a_exp);
+	operation();
+	decn_to_str_complete(&AccDecn);
+	CHECK_THAT(Buf, Equals(expected));
+	if (decn_is_zero(&AccDecn)){
+		CHECK(!(AccDecn.exponent < 0)); //no -0
+	}
+}
+
+TEST_CASE("trig exact values") {
+	//axes
+	trig_exact_test(sin_decn,  "0", 0, "0");
+	trig_exact_test(cos_decn,  "0", 0, "1.");
+	trig_exact_test(sin_decn, "90", 0, "1.");
+	trig_exact_test(cos_decn, "90", 0, "0");
+	trig_exact_test(tan_decn, "90", 0, "Error");
+	trig_exact_test(sin_decn, "180", 0, "0");
+	trig_exact_test(cos_decn, "180", 0, "-1.");
+	trig_exact_test(tan_decn, "180", 0, "0");
+	trig_exact_test(sin_decn, "270", 0, "-1.");
+	trig_exact_test(cos_decn, "270", 0, "0");
+	trig_exact_test(tan_decn, "270", 0, "Error");
+	trig_exact_test(sin_decn, "360", 0, "0");
+	trig_exact_test(cos_decn, "360", 0, "1.");
+	trig_exact_test(sin_decn, "-90", 0, "-1.");
+	trig_exact_test(cos_decn, "-90", 0, "0");
+	trig_exact_test(sin_decn, "-180", 0, "0");
+	trig_exact_test(tan_decn, "-270", 0, "Error");
+	trig_exact_test(sin_decn, "3600000000000000000", 0, "0");
+	trig_exact_test(cos_decn, "3600000000000000090", 0, "0");
+	//exact values off the axes
+	trig_exact_test(sin_decn,  "30", 0, "0.5");
+	trig_exact_test(sin_decn, "150", 0, "0.5");
+	trig_exact_test(sin_decn, "-30", 0, "-0.5");
+	trig_exact_test(cos_decn,  "60", 0, "0.5");
+	trig_exact_test(cos_decn, "120", 0, "-0.5");
+	trig_exact_test(tan_decn,  "45", 0, "1.");
+	trig_exact_test(tan_decn, "135", 0, "-1.");
+	trig_exact_test(tan_decn, "-45", 0, "-1.");
+	//inverse functions
+	trig_exact_test(arctan_decn,  "0", 0, "0");
+	trig_exact_test(arctan_decn,  "1", 0, "45.");
+	trig_exact_test(arctan_decn, "-1", 0, "-45.");
+	trig_exact_test(arcsin_decn,  "0", 0, "0");
+	trig_exact_test(arcsin_decn,  "0.5", 0, "30.");
+	trig_exact_test(arcsin_decn, "-0.5", 0, "-30.");
+	trig_exact_test(arcsin_decn,  "1", 0, "90.");
+	trig_exact_test(arcsin_decn, "-1", 0, "-90.");
+	trig_exact_test(arccos_decn,  "1", 0, "0");
+	trig_exact_test(arccos_decn, "-1", 0, "180.");
+	trig_exact_test(arccos_decn,  "0", 0, "90.");
+	trig_exact_test(arccos_decn,  "0.5", 0, "60.");
+	trig_exact_test(arccos_decn, "-0.5", 0, "120.");
+	//|x| > 1
+	trig_exact_test(arcsin_decn, "1.00000000000000001", 0, "Error");
+	trig_exact_test(arccos_decn, "-1.00000000000000001", 0, "Error");
+}
+
+
+TEST_CASE("trig axes") {
+	//sign and magnitude at multiples of 90 degrees
+	static const char* const sin_expected[] = {"0", "1.", "0", "-1."};
+	static const char* const cos_expected[] = {"1.", "0", "-1.", "0"};
+	static const char* const tan_expected[] = {"0", "Error", "0", "Error"};
+	for (int k = -8; k <= 8; k++){
+		std::string angle = std::to_string(90 * k);
+		int quadrant = ((k % 4) + 4) % 4; //(also for negative angles)
+		trig_exact_test(sin_decn, angle.c_str(), 0, sin_expected[quadrant]);
+		trig_exact_test(cos_decn, angle.c_str(), 0, cos_expected[quadrant]);
+		trig_exact_test(tan_decn, angle.c_str(), 0, tan_expected[quadrant]);
+	}
+}
+
+TEST_CASE("trig tiny angles") {
+	//relative tolerance only: the results must keep their digits, not just be near 0
+	static const char* const tiny[] = {"1", "-1", "3", "1.23456789012345678", "-9.87654321"};
+	static const int tiny_exp[] = {-300, -16000, -12, -10, -9};
+	for (int i = 0; i < 5; i++){
+		sin_test(tiny[i], tiny_exp[i], TRIG_RTOL, 0);
+		tan_test(tiny[i], tiny_exp[i], TRIG_RTOL, 0);
+		atan_test(tiny[i], tiny_exp[i], TRIG_RTOL, 0);
+		asin_test(tiny[i], tiny_exp[i], TRIG_RTOL, 0);
+		acos_test(tiny[i], tiny_exp[i]);
+		trig_exact_test(cos_decn, tiny[i], tiny_exp[i], "1.");
+	}
+	trig_exact_test(arctan_decn, "1", -300, "5.729577951308232E-299");
+	trig_exact_test(sin_decn, "-1", -300, "-1.74532925199433E-302");
+}
 
+//trig functions are now fast enough to be tested as thoroughly as the arithmetic functions
 TEST_CASE("sin random"){
 	std::default_random_engine gen;
-	std::uniform_int_distribution<int> distrib(0,99);
-	std::uniform_int_distribution<int> exp_distrib(0, 2); //restrict range for now
-	std::uniform_int_distribution<int> sign_distrib(0,1);
-	for (int j = 0; j < NUM_RAND_TRIG_TESTS; j++){
+	std::uniform_int_distribution<int> distrib(0, 99);
+	std::uniform_int_distribution<int> exp_distrib(-3, 3);
+	std::uniform_int_distribution<int> sign_distrib(0, 1);
+	for (int j = 0; j < NUM_RAND_TESTS; j++){
 		for (int i = 0; i < DEC80_NUM_LSU; i++){
-			AccDecn.lsu[i] = distrib(gen);
+			AccDecn.lsu[i] = digit100(distrib(gen));
 		}
 		int exp = exp_distrib(gen);
 		int sign = sign_distrib(gen);
 		set_exponent(&AccDecn, exp, sign);
 		remove_leading_zeros(&AccDecn);
-		int lsu0 = AccDecn.lsu[0];
+		int lsu0 = DIGIT100_VAL(AccDecn.lsu[0]);
 		exp = get_exponent(&AccDecn);
 		CAPTURE(lsu0);
 		CAPTURE(exp);
 		CAPTURE(sign);
-		if (exp <= -1){
-			//very small
-			sin_test(4000);
-		} else if (exp == 0 && lsu0 < 50){
-			//small
-			sin_test(0.4);
-		} else if (exp == 2 && lsu0 >= 17 && lsu0 <= 19){
-			//near 180
-			sin_test(3);
-		} else if (exp == 2 && lsu0 >= 35 && lsu0 <= 36){
-			//near 360
-			sin_test(12);
-		} else if (exp == 2 && lsu0 > 50){
-			//large
-			sin_test(35);
-		} else {
-			sin_test(0.02);
-		}
+		sin_test();
 	}
 }
 
 TEST_CASE("cos random"){
 	std::default_random_engine gen;
-	std::uniform_int_distribution<int> distrib(0,99);
-	std::uniform_int_distribution<int> exp_distrib(0, 2); //restrict range for now
-	std::uniform_int_distribution<int> sign_distrib(0,1);
-	for (int j = 0; j < NUM_RAND_TRIG_TESTS; j++){
+	std::uniform_int_distribution<int> distrib(0, 99);
+	std::uniform_int_distribution<int> exp_distrib(-3, 3);
+	std::uniform_int_distribution<int> sign_distrib(0, 1);
+	for (int j = 0; j < NUM_RAND_TESTS; j++){
 		for (int i = 0; i < DEC80_NUM_LSU; i++){
-			AccDecn.lsu[i] = distrib(gen);
+			AccDecn.lsu[i] = digit100(distrib(gen));
 		}
 		int exp = exp_distrib(gen);
 		int sign = sign_distrib(gen);
 		set_exponent(&AccDecn, exp, sign);
 		remove_leading_zeros(&AccDecn);
-		int lsu0 = AccDecn.lsu[0];
+		int lsu0 = DIGIT100_VAL(AccDecn.lsu[0]);
 		exp = get_exponent(&AccDecn);
 		CAPTURE(lsu0);
 		CAPTURE(exp);
 		CAPTURE(sign);
-		if (exp == 1 && lsu0 >= 89 && lsu0 <= 90){
-			//very near 90
-			cos_test(500);
-		} else if (exp == 1 && lsu0 >= 87 && lsu0 <= 92){
-			//near 90
-			cos_test(2);
-		} else if (exp == 2 && lsu0 >= 26 && lsu0 <= 27){
-			//near 270
-			cos_test(500);
-		} else if (exp == 2 && lsu0 >= 44){
-			//large
-			cos_test(20);
-		} else {
-			cos_test(0.02);
-		}
+		cos_test();
 	}
 }
 
 TEST_CASE("tan random"){
 	std::default_random_engine gen;
-	std::uniform_int_distribution<int> distrib(0,99);
-	std::uniform_int_distribution<int> exp_distrib(0, 2); //restrict range for now
-	std::uniform_int_distribution<int> sign_distrib(0,1);
-	for (int j = 0; j < NUM_RAND_TRIG_TESTS; j++){
+	std::uniform_int_distribution<int> distrib(0, 99);
+	std::uniform_int_distribution<int> exp_distrib(-3, 3);
+	std::uniform_int_distribution<int> sign_distrib(0, 1);
+	for (int j = 0; j < NUM_RAND_TESTS; j++){
 		for (int i = 0; i < DEC80_NUM_LSU; i++){
-			AccDecn.lsu[i] = distrib(gen);
+			AccDecn.lsu[i] = digit100(distrib(gen));
 		}
 		int exp = exp_distrib(gen);
 		int sign = sign_distrib(gen);
 		set_exponent(&AccDecn, exp, sign);
 		remove_leading_zeros(&AccDecn);
-		int lsu0 = AccDecn.lsu[0];
+		int lsu0 = DIGIT100_VAL(AccDecn.lsu[0]);
 		exp = get_exponent(&AccDecn);
 		CAPTURE(lsu0);
 		CAPTURE(exp);
 		CAPTURE(sign);
-		if (exp <= -3){
-			//extremely small
-			tan_test(5000);
-		} if (exp <= -1){
-			//very small
-			tan_test(400);
-		} else if (exp == 0 && lsu0 < 50){
-			//small
-			tan_test(1);
-		} else if (exp == 1 && lsu0 >= 89 && lsu0 <= 90){
-			//very near 90
-			tan_test(5);
-		} else if (exp == 1 && lsu0 >= 87 && lsu0 <= 92){
-			//near 90
-			tan_test(1);
-		} else if (exp == 2 && lsu0 >= 17 && lsu0 <= 19){
-			//near 180
-			tan_test(3);
-		} else if (exp == 2 && lsu0 >= 26 && lsu0 <= 27){
-			//near 270
-			tan_test(5);
-		} else if (exp == 2 && lsu0 >= 35 && lsu0 <= 37){
-			//near 360
-			tan_test(20);
-		} else if (exp == 2 && lsu0 >= 44){
-			//large
-			tan_test(50);
-		} else {
-			tan_test(0.02);
-		}
+		tan_test();
 	}
 }
 
 TEST_CASE("atan random"){
 	std::default_random_engine gen;
 	std::uniform_int_distribution<int> distrib(0, 99);
-	std::uniform_int_distribution<int> exp_distrib(-1, 0); //restrict range for now
+	std::uniform_int_distribution<int> exp_distrib(-6, 3);
 	std::uniform_int_distribution<int> sign_distrib(0, 1);
-	for (int j = 0; j < NUM_RAND_TRIG_TESTS; j++){
+	for (int j = 0; j < NUM_RAND_TESTS; j++){
 		for (int i = 0; i < DEC80_NUM_LSU; i++){
-			AccDecn.lsu[i] = distrib(gen);
+			AccDecn.lsu[i] = digit100(distrib(gen));
 		}
 		int exp = exp_distrib(gen);
 		int sign = sign_distrib(gen);
 		set_exponent(&AccDecn, exp, sign);
 		remove_leading_zeros(&AccDecn);
-		int lsu0 = AccDecn.lsu[0];
+		int lsu0 = DIGIT100_VAL(AccDecn.lsu[0]);
 		exp = get_exponent(&AccDecn);
 		CAPTURE(lsu0);
 		CAPTURE(exp);
 		CAPTURE(sign);
-		if (exp <= -6){
-			//extremely small
-			atan_test(10000);
-		} else if (exp < -1 || (exp == -1 && lsu0 == 0)){
-			//very small
-			atan_test(100);
-		} else if ((exp == -1 && lsu0 < 10) || (exp == 0 && lsu0 == 0)){
-			//small
-			atan_test(3);
-		} else {
-			atan_test(0.02);
-		}
+		atan_test();
 	}
 }
 
 TEST_CASE("asin random"){
 	std::default_random_engine gen;
 	std::uniform_int_distribution<int> distrib(0, 99);
-	std::uniform_int_distribution<int> exp_distrib(-2, -1); //restrict range for now
+	std::uniform_int_distribution<int> exp_distrib(-8, -1);
 	std::uniform_int_distribution<int> sign_distrib(0, 1);
-	for (int j = 0; j < NUM_RAND_TRIG_TESTS; j++){
+	for (int j = 0; j < NUM_RAND_TESTS; j++){
 		for (int i = 0; i < DEC80_NUM_LSU; i++){
-			AccDecn.lsu[i] = distrib(gen);
+			AccDecn.lsu[i] = digit100(distrib(gen));
 		}
 		int exp = exp_distrib(gen);
 		int sign = sign_distrib(gen);
 		set_exponent(&AccDecn, exp, sign);
 		remove_leading_zeros(&AccDecn);
-		int lsu0 = AccDecn.lsu[0];
+		int lsu0 = DIGIT100_VAL(AccDecn.lsu[0]);
 		exp = get_exponent(&AccDecn);
 		CAPTURE(lsu0);
 		CAPTURE(exp);
 		CAPTURE(sign);
-		if (exp <= -7) {
-			//extremely small
-			asin_test(50000);
-		} else if (exp < -5) {
-			//very very small
-			asin_test(1000);
-		} else if (exp < -1 || (exp == -1 && lsu0 == 0)){
-			//very small
-			asin_test(100);
-		} else if ((exp == -1 && lsu0 < 10) || (exp == 0 && lsu0 == 0)){
-			//small
-			asin_test(0.5);
-		} else {
-			asin_test(0.02);
-		}
+		asin_test();
 	}
 }
 
@@ -537,26 +602,21 @@ TEST_CASE("asin random"){
 TEST_CASE("acos random"){
 	std::default_random_engine gen;
 	std::uniform_int_distribution<int> distrib(0, 99);
-	std::uniform_int_distribution<int> exp_distrib(-2, -1); //restrict range for now
+	std::uniform_int_distribution<int> exp_distrib(-8, -1);
 	std::uniform_int_distribution<int> sign_distrib(0, 1);
-	for (int j = 0; j < NUM_RAND_TRIG_TESTS; j++){
+	for (int j = 0; j < NUM_RAND_TESTS; j++){
 		for (int i = 0; i < DEC80_NUM_LSU; i++){
-			AccDecn.lsu[i] = distrib(gen);
+			AccDecn.lsu[i] = digit100(distrib(gen));
 		}
 		int exp = exp_distrib(gen);
 		int sign = sign_distrib(gen);
 		set_exponent(&AccDecn, exp, sign);
 		remove_leading_zeros(&AccDecn);
-		int lsu0 = AccDecn.lsu[0];
+		int lsu0 = DIGIT100_VAL(AccDecn.lsu[0]);
 		exp = get_exponent(&AccDecn);
 		CAPTURE(lsu0);
 		CAPTURE(exp);
 		CAPTURE(sign);
-		if ((exp == -1 && lsu0 == 99)){
-			//near 1
-			acos_test(10);
-		} else {
-			acos_test(0.02);
-		}
+		acos_test();
 	}
 }
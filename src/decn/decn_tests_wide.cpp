@@ -0,0 +1,279 @@
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * decn_tests_wide.cpp
+ *
+ * Unit tests using https://github.com/catchorg/Catch2
+ *
+ * wide decimal numbers (decn_wide.h), and checks of the decn functions against them
+ */
+
+
+#include <string>
+#include <cstring>
+#include <random>
+#include <boost/multiprecision/mpfr.hpp>
+#include <catch2/catch.hpp>
+#include "decn.h"
+#include "decn_wide.h"
+#include "../utils.h"
+
+#include "decn_tests.h"
+
+
+namespace bmp = boost::multiprecision;
+using Catch::Matchers::Equals;
+
+
+//random value with num_digits digits
+static decn_wide random_wide(std::default_random_engine& gen, size_t num_digits, int min_exp, int max_exp){
+	std::uniform_int_distribution<int> digit_distrib(0, 9);
+	std::uniform_int_distribution<int> exp_distrib(min_exp, max_exp);
+	std::uniform_int_distribution<int> sign_distrib(0, 1);
+	std::string str = sign_distrib(gen) ? "-" : "";
+	str += '1' + digit_distrib(gen) % 9;
+	str += '.';
+	for (size_t i = 1; i < num_digits; i++){
+		str += '0' + digit_distrib(gen);
+	}
+	str += 'e' + std::to_string(exp_distrib(gen));
+	return decn_wide(str.c_str());
+}
+
+static void check_rel_diff(const decn_wide& calculated, const bmp::mpfr_float& actual, double epsilon){
+	std::string str = calculated.to_string(2 * decn_wide::precision());
+	CAPTURE(str);
+	CAPTURE(actual);
+	bmp::mpfr_float rel_diff = abs((bmp::mpfr_float(str) - actual) / actual);
+	CHECK(rel_diff < epsilon);
+}
+
+TEST_CASE("wide build"){
+	CHECK(decn_wide("0").is_zero());
+	CHECK(decn_wide("-0.000").is_zero());
+	CHECK(decn_wide("").is_nan());
+	CHECK(decn_wide("1.2.3").is_nan());
+	CHECK(decn_wide("12x").is_nan());
+	CHECK_THAT(decn_wide("1234.5").to_string(6), Equals("1.23450e3"));
+	CHECK_THAT(decn_wide("-0.00012345").to_string(5), Equals("-1.2345e-4"));
+	CHECK_THAT(decn_wide("9.99996").to_string(5), Equals("1.0000e1"));
+	CHECK_THAT(decn_wide("1.25e-300").to_string(3), Equals("1.25e-300"));
+	CHECK_THAT(decn_wide(-2147483647).to_string(10), Equals("-2.147483647e9"));
+
+	//dec80 round trip
+	build_dec80("-1.23456789012345678", -12345);
+	decn_wide x(AccDecn);
+	CHECK_THAT(x.to_string(18), Equals("-1.23456789012345678e-12345"));
+	dec80 y;
+	x.to_dec80(&y);
+	CHECK(y.exponent == AccDecn.exponent);
+	CHECK(memcmp(y.lsu, AccDecn.lsu, DEC80_NUM_LSU) == 0);
+	//rounded to 18 digits
+	decn_wide("2.9999999999999999996").to_dec80(&y);
+	decn_to_str_complete(&y);
+	CHECK_THAT(Buf, Equals("3."));
+	//out of range
+	decn_wide("1e20000").to_dec80(&y);
+	CHECK(decn_is_nan(&y));
+	decn_wide("1e-20000").to_dec80(&y);
+	CHECK(decn_is_zero(&y));
+}
+
+TEST_CASE("wide arithmetic"){
+	bmp::mpfr_float::default_precision(60);
+	decn_wide::scoped_precision precision(25);
+	std::default_random_engine gen;
+	for (int j = 0; j < NUM_RAND_TESTS / 100; j++){
+		decn_wide a = random_wide(gen, 50, -30, 30);
+		decn_wide b = random_wide(gen, 50, -30, 30);
+		bmp::mpfr_float a_actual(a.to_string(50));
+		bmp::mpfr_float b_actual(b.to_string(50));
+		CAPTURE(a_actual);
+		CAPTURE(b_actual);
+		check_rel_diff(a * b, a_actual * b_actual, 1e-47);
+		check_rel_diff(a / b, a_actual / b_actual, 1e-47);
+		check_rel_diff(sqrt(abs(a)), sqrt(abs(a_actual)), 1e-47);
+		//(no cancellation)
+		if (a.is_neg() == b.is_neg()){
+			check_rel_diff(a + b, a_actual + b_actual, 1e-47);
+		} else {
+			check_rel_diff(a - b, a_actual - b_actual, 1e-47);
+		}
+	}
+	//exact
+	CHECK((decn_wide(3) - decn_wide(3)).is_zero());
+	CHECK(decn_wide(1) / decn_wide(8) == decn_wide("0.125"));
+	CHECK(decn_wide("1.5") / decn_wide(3) == decn_wide("0.5"));
+	CHECK(sqrt(decn_wide("1.44e-10")) == decn_wide("1.2e-5"));
+	CHECK(decn_wide(-3) < decn_wide(2));
+	CHECK(decn_wide(-3) < decn_wide(-2));
+	CHECK(decn_wide("1e-5") > decn_wide("0"));
+	CHECK((decn_wide(1) / decn_wide(0)).is_nan());
+	CHECK(sqrt(decn_wide(-1)).is_nan());
+	CHECK(!(decn_wide::nan() == decn_wide::nan()));
+}
+
+TEST_CASE("wide karatsuba"){
+	//products of values with 500 digit100s are exact with 1000 digit100s:
+	// compare against the sum of the products of 20 digit100 pieces (schoolbook)
+	decn_wide::scoped_precision precision(1010);
+	std::default_random_engine gen;
+	for (int j = 0; j < 5; j++){
+		decn_wide a = random_wide(gen, 1000, -5, 5);
+		decn_wide b = random_wide(gen, 999 - 2 * j, -5, 5);
+		decn_wide sum;
+		std::string a_str = a.to_string(1000);
+		CAPTURE(a_str);
+		std::string mant = a_str.substr(a.is_neg() ? 3 : 2, 999);
+		int exp = std::stoi(a_str.substr(a_str.find('e') + 1));
+		//first digit
+		sum = decn_wide(a_str.substr(0, a.is_neg() ? 2 : 1).append("e").append(std::to_string(exp)).c_str()) * b;
+		for (size_t i = 0; i < mant.size(); i += 40){
+			std::string piece = (a.is_neg() ? "-0." : "0.") + mant.substr(i, 40) +
+				"e" + std::to_string(exp - (int) i);
+			sum += decn_wide(piece.c_str()) * b;
+		}
+		CHECK(sum == a * b);
+	}
+}
+
+TEST_CASE("wide constants"){
+	decn_wide::scoped_precision precision(60);
+	CHECK_THAT(exp(decn_wide(1)).to_string(100), Equals(
+		"2.718281828459045235360287471352662497757247093699959574966967627724076630353547594571382178525166427e0"));
+	CHECK_THAT(sqrt(decn_wide(2)).to_string(100), Equals(
+		"1.414213562373095048801688724209698078569671875376948073176679737990732478462107038850387534327641573e0"));
+	CHECK_THAT(ln(decn_wide(10)).to_string(100), Equals(
+		"2.302585092994045684017991454684364207601101488628772976033327900967572609677352480235997205089598298e0"));
+	//binary splitting
+	CHECK_THAT(decn_wide::pi().to_string(100), Equals(
+		"3.141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117068e0"));
+	CHECK_THAT(decn_wide::ln10().to_string(100), Equals(
+		"2.302585092994045684017991454684364207601101488628772976033327900967572609677352480235997205089598298e0"));
+	//cached at a higher precision
+	decn_wide::set_precision(10);
+	CHECK_THAT(decn_wide::pi().to_string(19), Equals("3.141592653589793238e0"));
+}
+
+TEST_CASE("wide agm newton"){
+	//the algorithms for high precision agree with the ones for low precision
+	decn_wide::scoped_precision precision(300);
+	std::default_random_engine gen;
+	for (int j = 0; j < 10; j++){
+		decn_wide x = abs(random_wide(gen, 600, -20, 20));
+		CAPTURE(x.to_string(20));
+		decn_wide ln_x = ln_newton(x);
+		CHECK(abs((ln_agm(x) - ln_x) / ln_x) < decn_wide("1e-595"));
+		decn_wide y = random_wide(gen, 600, -10, 2);
+		CAPTURE(y.to_string(20));
+		decn_wide exp_y = exp_taylor(y);
+		CHECK(abs((exp_newton(y) - exp_y) / exp_y) < decn_wide("1e-595"));
+	}
+	//near 1
+	decn_wide x("1.00000000000000000000000000000000000000000123");
+	CHECK(abs((ln_agm(x) - ln_newton(x)) / ln_newton(x)) < decn_wide("1e-595"));
+	CHECK(ln_agm(decn_wide(1)).is_zero());
+	CHECK(ln_agm(decn_wide(-1)).is_nan());
+	CHECK(exp_newton(decn_wide(0)) == decn_wide(1));
+}
+
+TEST_CASE("wide ln exp"){
+	bmp::mpfr_float::default_precision(60);
+	decn_wide::scoped_precision precision(25);
+	std::default_random_engine gen;
+	for (int j = 0; j < NUM_RAND_TESTS / 1000; j++){
+		decn_wide x = abs(random_wide(gen, 50, -30, 30));
+		bmp::mpfr_float x_actual(x.to_string(50));
+		CAPTURE(x_actual);
+		check_rel_diff(ln(x), log(x_actual), 1e-47);
+		decn_wide y = random_wide(gen, 50, -3, 2);
+		bmp::mpfr_float y_actual(y.to_string(50));
+		CAPTURE(y_actual);
+		check_rel_diff(exp(y), exp(y_actual), 1e-46);
+	}
+	//near 1
+	check_rel_diff(ln(decn_wide("1.000000000000000000000000000001")),
+		bmp::mpfr_float("9.9999999999999999999999999999950000000000000000000e-31"), 1e-47);
+	CHECK(ln(decn_wide(1)).is_zero());
+	CHECK(ln(decn_wide(0)).is_nan());
+	CHECK(ln(decn_wide(-2)).is_nan());
+	CHECK(exp(decn_wide("-1e20")).is_zero());
+	CHECK(exp(decn_wide("1e20")).is_nan());
+
+	//high precision
+	decn_wide::set_precision(500);
+	decn_wide x("0.1234567");
+	decn_wide diff = abs(ln(exp(x)) - x);
+	CAPTURE(diff.to_string(5));
+	CHECK(diff < decn_wide("1e-995"));
+}
+
+//check the decn functions against decn_wide results
+TEST_CASE("wide cross check"){
+	decn_wide::scoped_precision precision(DECN_WIDE_DEFAULT_NUM_LSU);
+	std::default_random_engine gen;
+	std::uniform_int_distribution<int> distrib(0, 99);
+	std::uniform_int_distribution<int> exp_distrib(-99, 99);
+	std::uniform_int_distribution<int> sign_distrib(0, 1);
+	dec80 a, b, expected;
+	for (int j = 0; j < NUM_RAND_TESTS / 10; j++){
+		for (int i = 0; i < DEC80_NUM_LSU; i++){
+			a.lsu[i] = digit100(distrib(gen));
+			b.lsu[i] = digit100(distrib(gen));
+		}
+		a.lsu[0] = digit100(10 + distrib(gen) % 90);
+		b.lsu[0] = digit100(10 + distrib(gen) % 90);
+		set_exponent(&a, exp_distrib(gen), sign_distrib(gen));
+		set_exponent(&b, exp_distrib(gen), sign_distrib(gen));
+		decn_wide a_wide(a), b_wide(b);
+		CAPTURE(a_wide.to_string(18));
+		CAPTURE(b_wide.to_string(18));
+
+		//division and square root are correctly rounded
+		copy_decn(&AccDecn, &a);
+		copy_decn(&BDecn, &b);
+		div_decn();
+		(a_wide / b_wide).to_dec80(&expected);
+		CHECK(AccDecn.exponent == expected.exponent);
+		CHECK(memcmp(AccDecn.lsu, expected.lsu, DEC80_NUM_LSU) == 0);
+
+		copy_decn(&AccDecn, &a);
+		AccDecn.exponent &= 0x7fff; //positive
+		sqrt_decn();
+		sqrt(abs(a_wide)).to_dec80(&expected);
+		CHECK(AccDecn.exponent == expected.exponent);
+		CHECK(memcmp(AccDecn.lsu, expected.lsu, DEC80_NUM_LSU) == 0);
+
+		copy_decn(&AccDecn, &a);
+		mult_decn();
+		decn_wide product = a_wide * b_wide;
+		CHECK(abs((decn_wide(AccDecn) - product) / product) < decn_wide("1e-17"));
+
+		//ln away from 1, and exp in range
+		if (j % 10 == 0){
+			copy_decn(&AccDecn, &a);
+			AccDecn.exponent &= 0x7fff;
+			if (get_exponent(&AccDecn) != 0 && get_exponent(&AccDecn) != -1){
+				ln_decn();
+				decn_wide ln_wide = ln(abs(a_wide));
+				CHECK(abs((decn_wide(AccDecn) - ln_wide) / ln_wide) < decn_wide("2e-16"));
+			}
+			set_exponent(&a, exp_distrib(gen) % 2, sign_distrib(gen));
+			copy_decn(&AccDecn, &a);
+			exp_decn();
+			decn_wide exp_wide = exp(decn_wide(a));
+			CHECK(abs((decn_wide(AccDecn) - exp_wide) / exp_wide) < decn_wide("2e-15"));
+		}
+	}
+}
@@ -0,0 +1,1031 @@
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * decn_wide.cpp
+ *
+ * wide decimal numbers, see decn_wide.h
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "decn_wide.h"
+
+
+namespace {
+
+//free lists of digit100 arrays, by size class (power of 2 digit100s), so that
+// calculations don't keep going to the heap for their temporaries
+const size_t POOL_MIN_SIZE_CLASS = 4; //16 digit100s
+const size_t POOL_NUM_SIZE_CLASSES = 32;
+
+size_t pool_size_class(size_t num_lsu){
+	size_t size_class = POOL_MIN_SIZE_CLASS;
+	while (((size_t) 1 << size_class) < num_lsu){
+		size_class++;
+	}
+	return size_class;
+}
+
+class limb_pool;
+thread_local limb_pool* Pool = nullptr;
+
+class limb_pool {
+public:
+	limb_pool() { Pool = this; }
+	~limb_pool(){
+		Pool = nullptr;
+		for (auto& free_list : free_lists){
+			for (uint8_t* lsu : free_list){
+				delete[] lsu;
+			}
+		}
+	}
+
+	uint8_t* get(size_t num_lsu, size_t& capacity){
+		size_t size_class = pool_size_class(num_lsu);
+		capacity = (size_t) 1 << size_class;
+		std::vector<uint8_t*>& free_list = free_lists[size_class];
+		if (free_list.empty()){
+			return new uint8_t[capacity];
+		}
+		uint8_t* lsu = free_list.back();
+		free_list.pop_back();
+		return lsu;
+	}
+
+	void put(uint8_t* lsu, size_t capacity){
+		free_lists[pool_size_class(capacity)].push_back(lsu);
+	}
+
+private:
+	std::vector<uint8_t*> free_lists[POOL_NUM_SIZE_CLASSES];
+};
+
+thread_local limb_pool ThreadPool;
+
+uint8_t* pool_get(size_t num_lsu, size_t& capacity){
+	if (!Pool){
+		(void) &ThreadPool; //construct this thread's pool
+	}
+	if (!Pool){
+		//(during thread exit, after the pool is destroyed)
+		capacity = (size_t) 1 << pool_size_class(num_lsu);
+		return new uint8_t[capacity];
+	}
+	return Pool->get(num_lsu, capacity);
+}
+
+void pool_put(uint8_t* lsu, size_t capacity){
+	if (Pool){
+		Pool->put(lsu, capacity);
+	} else {
+		delete[] lsu;
+	}
+}
+
+//zeroed temporary digit100s
+struct limb_buf {
+	uint8_t* lsu;
+	size_t capacity;
+
+	explicit limb_buf(size_t num_lsu) : lsu(pool_get(num_lsu, capacity)) {
+		memset(lsu, 0, num_lsu);
+	}
+	~limb_buf() { pool_put(lsu, capacity); }
+	limb_buf(const limb_buf&) = delete;
+	limb_buf& operator=(const limb_buf&) = delete;
+};
+
+thread_local size_t Precision = DECN_WIDE_DEFAULT_NUM_LSU;
+
+//coefficients for multiplication (the products of digit100s are summed
+// without carries), reused between multiplications
+thread_local std::vector<uint64_t> MultScratch;
+
+//c[0 .. na + nb - 1) = a[0 .. na) * b[0 .. nb), as polynomials
+void mult_schoolbook(uint64_t* c, const uint64_t* a, size_t na, const uint64_t* b, size_t nb){
+	std::fill(c, c + na + nb - 1, 0);
+	for (size_t i = 0; i < na; i++){
+		for (size_t j = 0; j < nb; j++){
+			c[i + j] += a[i] * b[j];
+		}
+	}
+}
+
+//size of the scratch space needed by mult_karatsuba()
+size_t karatsuba_scratch_size(size_t n){
+	if (n <= DECN_WIDE_KARATSUBA_NUM_LSU){
+		return 0;
+	}
+	size_t k = n - n / 2;
+	return 4 * k - 1 + karatsuba_scratch_size(k);
+}
+
+//c[0 .. 2n - 1) = a[0 .. n) * b[0 .. n), as polynomials
+//with a = a0 + x^m a1 and b = b0 + x^m b1:
+// a * b = a0 b0 + x^m ((a0 + a1) (b0 + b1) - a0 b0 - a1 b1) + x^2m a1 b1,
+// 3 multiplications of half the size instead of 4
+//the middle difference can wrap around in unsigned arithmetic, but its true
+// value (a0 b1 + a1 b0) is not negative, so it always comes out exact
+void mult_karatsuba(uint64_t* c, const uint64_t* a, const uint64_t* b, size_t n, uint64_t* scratch){
+	if (n <= DECN_WIDE_KARATSUBA_NUM_LSU){
+		mult_schoolbook(c, a, n, b, n);
+		return;
+	}
+	size_t m = n / 2; //size of a0 and b0
+	size_t k = n - m; //size of a1 and b1 (>= m)
+	uint64_t* sum_a = scratch;
+	uint64_t* sum_b = scratch + k;
+	uint64_t* mid = scratch + 2 * k;
+	uint64_t* rest = scratch + 4 * k - 1;
+
+	//a0 b0 in c[0 .. 2m - 1), a1 b1 in c[2m .. 2n - 1)
+	mult_karatsuba(c, a, b, m, rest);
+	c[2 * m - 1] = 0;
+	mult_karatsuba(c + 2 * m, a + m, b + m, k, rest);
+
+	for (size_t i = 0; i < k; i++){
+		sum_a[i] = a[m + i] + (i < m ? a[i] : 0);
+		sum_b[i] = b[m + i] + (i < m ? b[i] : 0);
+	}
+	mult_karatsuba(mid, sum_a, sum_b, k, rest);
+	for (size_t i = 0; i < 2 * m - 1; i++){
+		mid[i] -= c[i];
+	}
+	for (size_t i = 0; i < 2 * k - 1; i++){
+		mid[i] -= c[2 * m + i];
+	}
+	for (size_t i = 0; i < 2 * k - 1; i++){
+		c[m + i] += mid[i];
+	}
+}
+
+//digit100 counts for Newton's method: each iteration doubles the number of
+// correct digits, so only the last iteration needs the full precision
+//returns the precisions from smallest (about what a double gives) to num_lsu
+std::vector<size_t> newton_precisions(size_t num_lsu){
+	std::vector<size_t> precisions;
+	for (size_t p = num_lsu; ; p = p / 2 + 1){
+		precisions.push_back(p);
+		if (p <= 8){
+			break;
+		}
+	}
+	std::reverse(precisions.begin(), precisions.end());
+	return precisions;
+}
+
+//binary splitting: the sum of terms [a, b) of a series of rational terms is
+// kept as a fraction of integers, and the halves are combined with a few
+// multiplications of large integers (which Karatsuba makes fast), instead of
+// dividing for each term
+//(the integers are exact until they are longer than the precision)
+
+//Chudnovsky's series for 1/pi: about 14 digits per term
+struct chudnovsky_split {
+	decn_wide p, q, r;
+};
+
+void chudnovsky(int32_t a, int32_t b, const decn_wide& c3_24, chudnovsky_split& res){
+	if (b - a == 1){
+		decn_wide a_wide(a);
+		res.p = -(decn_wide(6 * a - 5) * decn_wide(2 * a - 1) * decn_wide(6 * a - 1));
+		res.q = a_wide * a_wide * a_wide * c3_24;
+		res.r = res.p * (decn_wide(545140134) * a_wide + decn_wide(13591409));
+		return;
+	}
+	int32_t m = (a + b) / 2;
+	chudnovsky_split right;
+	chudnovsky(a, m, c3_24, res);
+	chudnovsky(m, b, c3_24, right);
+	res.r = right.q * res.r + res.p * right.r;
+	res.p *= right.p;
+	res.q *= right.q;
+}
+
+//atanh(1/q) = sum 1/((2k + 1) q^(2k + 1))
+struct atanh_split {
+	decn_wide q, b, t;
+};
+
+void atanh_recip(int32_t q, int32_t a, int32_t b, atanh_split& res){
+	if (b - a == 1){
+		res.q = (a == 0) ? decn_wide(q) : decn_wide(q * q);
+		res.b = decn_wide(2 * a + 1);
+		res.t = decn_wide(1);
+		return;
+	}
+	int32_t m = (a + b) / 2;
+	atanh_split right;
+	atanh_recip(q, a, m, res);
+	atanh_recip(q, m, b, right);
+	res.t = res.t * right.b * right.q + right.t * res.b;
+	res.q *= right.q;
+	res.b *= right.b;
+}
+
+decn_wide atanh_recip(int32_t q){
+	int32_t num_terms = (int32_t) (Precision * std::log(100.0) / (2 * std::log((double) q))) + 2;
+	atanh_split sum;
+	atanh_recip(q, 0, num_terms, sum);
+	return sum.t / (sum.b * sum.q);
+}
+
+} //namespace
+
+
+size_t decn_wide::precision(){
+	return Precision;
+}
+
+void decn_wide::set_precision(size_t num_lsu){
+	Precision = std::max(num_lsu, (size_t) 2);
+}
+
+decn_wide::scoped_precision::scoped_precision(size_t num_lsu) : prev_num_lsu(Precision) {
+	set_precision(num_lsu);
+}
+
+decn_wide::scoped_precision::~scoped_precision(){
+	Precision = prev_num_lsu;
+}
+
+void decn_wide::alloc(size_t num_lsu){
+	lsu_ = pool_get(num_lsu, capacity_);
+	num_lsu_ = num_lsu;
+}
+
+void decn_wide::release(){
+	if (lsu_){
+		pool_put(lsu_, capacity_);
+	}
+	lsu_ = nullptr;
+	capacity_ = 0;
+	num_lsu_ = 0;
+}
+
+void decn_wide::round_to(size_t num_lsu){
+	if (num_lsu_ > num_lsu){
+		bool round_up = (lsu_[num_lsu] >= 50);
+		num_lsu_ = num_lsu;
+		for (size_t i = num_lsu; round_up && i > 0; i--){
+			round_up = (lsu_[i - 1] == 99);
+			lsu_[i - 1] = round_up ? 0 : lsu_[i - 1] + 1;
+		}
+		if (round_up){
+			//all 99s: rounds up to 1 digit100
+			lsu_[0] = 1;
+			num_lsu_ = 1;
+			exponent_++;
+		}
+	}
+	while (num_lsu_ > 0 && lsu_[num_lsu_ - 1] == 0){
+		num_lsu_--;
+	}
+	if (num_lsu_ == 0){
+		exponent_ = 0;
+		neg_ = false;
+	}
+}
+
+decn_wide::decn_wide() :
+	exponent_(0), neg_(false), nan_(false), num_lsu_(0), capacity_(0), lsu_(nullptr) {
+}
+
+decn_wide::decn_wide(int32_t x) : decn_wide() {
+	//0.buf[0] ... buf[4] * 100^5
+	uint8_t buf[5];
+	uint32_t x_abs = (x < 0) ? 0u - (uint32_t) x : (uint32_t) x;
+	for (int i = 4; i >= 0; i--){
+		buf[i] = x_abs % 100;
+		x_abs /= 100;
+	}
+	*this = make(buf, 5, 5, x < 0);
+}
+
+decn_wide::decn_wide(const dec80& x) : decn_wide() {
+	if (decn_is_nan(&x)){
+		nan_ = true;
+		return;
+	}
+	if (decn_is_zero(&x)){
+		return;
+	}
+	//x is d0.d1 d2 ... * 10^exponent
+	uint8_t digits[2 * DEC80_NUM_LSU];
+	for (int i = 0; i < DEC80_NUM_LSU; i++){
+		digits[2 * i] = DIGIT100_VAL(x.lsu[i]) / 10;
+		digits[2 * i + 1] = DIGIT100_VAL(x.lsu[i]) % 10;
+	}
+	*this = from_digits(digits, 2 * DEC80_NUM_LSU, get_exponent(&x) + 1, x.exponent < 0);
+}
+
+decn_wide::decn_wide(const char* str) : decn_wide() {
+	bool neg = false;
+	bool seen_point = false;
+	bool seen_digit = false;
+	int32_t exponent = 0;
+	std::vector<uint8_t> digits;
+
+	if (*str == '-'){
+		neg = true;
+		str++;
+	} else if (*str == '+'){
+		str++;
+	}
+	for (; *str; str++){
+		if (*str == '.' && !seen_point){
+			seen_point = true;
+		} else if (*str >= '0' && *str <= '9'){
+			seen_digit = true;
+			if (digits.empty() && *str == '0'){
+				//leading zero
+				if (seen_point){
+					exponent--;
+				}
+			} else {
+				digits.push_back(*str - '0');
+				if (!seen_point){
+					exponent++;
+				}
+			}
+		} else {
+			break;
+		}
+	}
+	if (seen_digit && (*str == 'e' || *str == 'E')){
+		char* end;
+		exponent += strtol(str + 1, &end, 10);
+		str = end;
+	}
+	if (!seen_digit || *str != '\0'){
+		nan_ = true;
+		return;
+	}
+	*this = from_digits(digits.data(), digits.size(), exponent, neg);
+}
+
+decn_wide::decn_wide(const decn_wide& x) :
+	exponent_(x.exponent_), neg_(x.neg_), nan_(x.nan_), num_lsu_(0), capacity_(0), lsu_(nullptr) {
+	if (x.num_lsu_){
+		alloc(x.num_lsu_);
+		memcpy(lsu_, x.lsu_, num_lsu_);
+	}
+}
+
+decn_wide::decn_wide(decn_wide&& x) noexcept :
+	exponent_(x.exponent_), neg_(x.neg_), nan_(x.nan_), num_lsu_(x.num_lsu_),
+	capacity_(x.capacity_), lsu_(x.lsu_) {
+	x.lsu_ = nullptr;
+	x.capacity_ = 0;
+	x.num_lsu_ = 0;
+}
+
+decn_wide& decn_wide::operator=(const decn_wide& x){
+	if (this != &x){
+		if (capacity_ < x.num_lsu_){
+			release();
+			alloc(x.num_lsu_);
+		}
+		num_lsu_ = x.num_lsu_;
+		if (num_lsu_){
+			memcpy(lsu_, x.lsu_, num_lsu_);
+		}
+		exponent_ = x.exponent_;
+		neg_ = x.neg_;
+		nan_ = x.nan_;
+	}
+	return *this;
+}
+
+decn_wide& decn_wide::operator=(decn_wide&& x) noexcept {
+	if (this != &x){
+		release();
+		exponent_ = x.exponent_;
+		neg_ = x.neg_;
+		nan_ = x.nan_;
+		num_lsu_ = x.num_lsu_;
+		capacity_ = x.capacity_;
+		lsu_ = x.lsu_;
+		x.lsu_ = nullptr;
+		x.capacity_ = 0;
+		x.num_lsu_ = 0;
+	}
+	return *this;
+}
+
+decn_wide::~decn_wide(){
+	release();
+}
+
+decn_wide decn_wide::nan(){
+	decn_wide x;
+	x.nan_ = true;
+	return x;
+}
+
+decn_wide decn_wide::pi(){
+	thread_local decn_wide cached;
+	thread_local size_t cached_num_lsu = 0;
+	size_t num_lsu = Precision;
+	if (cached_num_lsu < num_lsu){
+		scoped_precision precision(num_lsu + 2);
+		//pi = 426880 sqrt(10005) / (13591409 + sum of the terms)
+		chudnovsky_split sum;
+		chudnovsky(1, (int32_t) (2 * num_lsu / 14) + 2, decn_wide("10939058860032000"), sum);
+		cached = decn_wide(426880) * sqrt(decn_wide(10005)) * sum.q /
+			(decn_wide(13591409) * sum.q + sum.r);
+		cached_num_lsu = num_lsu;
+	}
+	decn_wide res = cached;
+	res.round_to(num_lsu);
+	return res;
+}
+
+decn_wide decn_wide::ln10(){
+	thread_local decn_wide cached;
+	thread_local size_t cached_num_lsu = 0;
+	size_t num_lsu = Precision;
+	if (cached_num_lsu < num_lsu){
+		scoped_precision precision(num_lsu + 2);
+		//Machin-like formula
+		cached = decn_wide(46) * atanh_recip(31) + decn_wide(34) * atanh_recip(49) +
+			decn_wide(20) * atanh_recip(161);
+		cached_num_lsu = num_lsu;
+	}
+	decn_wide res = cached;
+	res.round_to(num_lsu);
+	return res;
+}
+
+decn_wide decn_wide::make(const uint8_t* buf, size_t n, int32_t exponent, bool neg){
+	decn_wide x;
+	//remove leading zeros
+	size_t first = 0;
+	while (first < n && buf[first] == 0){
+		first++;
+	}
+	if (first == n){
+		return x; //zero
+	}
+	//round (from 1 digit100 beyond the precision), and remove trailing zeros
+	size_t num_lsu = std::min(n - first, Precision + 1);
+	x.alloc(num_lsu);
+	memcpy(x.lsu_, buf + first, num_lsu);
+	x.exponent_ = exponent - (int32_t) first;
+	x.neg_ = neg;
+	x.round_to(Precision);
+	return x;
+}
+
+decn_wide decn_wide::from_digits(const uint8_t* digits, size_t n, int32_t exponent, bool neg){
+	//digit100s start at an even power of 10: shift right 1 digit for odd exponents
+	size_t shift = exponent & 1;
+	size_t num_lsu = std::min((n + shift + 1) / 2, Precision + 1);
+	limb_buf buf(num_lsu);
+	for (size_t i = 0; i < 2 * num_lsu; i++){
+		if (i >= shift && i - shift < n){
+			buf.lsu[i / 2] += (i & 1) ? digits[i - shift] : 10 * digits[i - shift];
+		}
+	}
+	return make(buf.lsu, num_lsu, (exponent + (int32_t) shift) / 2, neg);
+}
+
+decn_wide decn_wide::from_double(double m, int32_t exponent){
+	char str[32];
+	snprintf(str, sizeof str, "%.17e", m);
+	decn_wide x(str);
+	if (!x.is_zero()){
+		x.exponent_ += exponent;
+	}
+	return x;
+}
+
+void decn_wide::to_double_parts(double& m, int32_t& exponent) const {
+	m = 0;
+	double scale = 0.01;
+	for (size_t i = 0; i < num_lsu_ && i < 9; i++){
+		m += lsu_[i] * scale;
+		scale *= 0.01;
+	}
+	if (neg_){
+		m = -m;
+	}
+	exponent = exponent_;
+}
+
+double decn_wide::to_double() const {
+	if (nan_){
+		return NAN;
+	}
+	double m;
+	int32_t exponent;
+	to_double_parts(m, exponent);
+	return m * pow(100.0, exponent);
+}
+
+void decn_wide::round_digits(uint8_t* digits, size_t num_digits, int32_t& exponent) const {
+	//skip the leading zero digit if lsu_[0] < 10
+	size_t first = (lsu_[0] < 10) ? 1 : 0;
+	exponent = 2 * exponent_ - (int32_t) first;
+	auto digit = [this](size_t i) -> uint8_t {
+		if (i / 2 >= num_lsu_){
+			return 0;
+		}
+		return (i & 1) ? lsu_[i / 2] % 10 : lsu_[i / 2] / 10;
+	};
+	for (size_t i = 0; i < num_digits; i++){
+		digits[i] = digit(first + i);
+	}
+	//round half up
+	if (digit(first + num_digits) >= 5){
+		size_t i = num_digits;
+		while (i > 0 && digits[i - 1] == 9){
+			digits[i - 1] = 0;
+			i--;
+		}
+		if (i > 0){
+			digits[i - 1]++;
+		} else {
+			//all 9s: rounds up to 1000...
+			digits[0] = 1;
+			exponent++;
+		}
+	}
+}
+
+void decn_wide::to_dec80(dec80* dest) const {
+	if (nan_){
+		set_dec80_NaN(dest);
+		return;
+	}
+	if (is_zero()){
+		set_dec80_zero(dest);
+		return;
+	}
+	uint8_t digits[2 * DEC80_NUM_LSU];
+	int32_t exponent;
+	round_digits(digits, 2 * DEC80_NUM_LSU, exponent);
+	exponent--; //for d0.d1 d2 ...
+	if (exponent > DEC80_MAX_EXP){
+		set_dec80_NaN(dest);
+		return;
+	}
+	if (exponent < DEC80_MIN_EXP){
+		set_dec80_zero(dest);
+		return;
+	}
+	for (int i = 0; i < DEC80_NUM_LSU; i++){
+		dest->lsu[i] = DIGIT100(digits[2 * i] * 10 + digits[2 * i + 1]);
+	}
+	set_exponent(dest, exponent, neg_);
+}
+
+std::string decn_wide::to_string(size_t num_digits) const {
+	if (nan_){
+		return "NaN";
+	}
+	if (is_zero()){
+		return "0";
+	}
+	num_digits = std::max(num_digits, (size_t) 1);
+	std::vector<uint8_t> digits(num_digits);
+	int32_t exponent;
+	round_digits(digits.data(), num_digits, exponent);
+	std::string str;
+	if (neg_){
+		str += '-';
+	}
+	str += (char) ('0' + digits[0]);
+	if (num_digits > 1){
+		str += '.';
+		for (size_t i = 1; i < num_digits; i++){
+			str += (char) ('0' + digits[i]);
+		}
+	}
+	str += 'e';
+	str += std::to_string(exponent - 1);
+	return str;
+}
+
+int decn_wide::compare_mag(const decn_wide& a, const decn_wide& b){
+	if (a.is_zero() || b.is_zero()){
+		return !a.is_zero() - !b.is_zero();
+	}
+	if (a.exponent_ != b.exponent_){
+		return (a.exponent_ > b.exponent_) ? 1 : -1;
+	}
+	size_t n = std::max(a.num_lsu_, b.num_lsu_);
+	for (size_t i = 0; i < n; i++){
+		uint8_t a_i = (i < a.num_lsu_) ? a.lsu_[i] : 0;
+		uint8_t b_i = (i < b.num_lsu_) ? b.lsu_[i] : 0;
+		if (a_i != b_i){
+			return (a_i > b_i) ? 1 : -1;
+		}
+	}
+	return 0;
+}
+
+bool operator==(const decn_wide& a, const decn_wide& b){
+	if (a.nan_ || b.nan_){
+		return false;
+	}
+	return a.neg_ == b.neg_ && decn_wide::compare_mag(a, b) == 0;
+}
+
+bool operator<(const decn_wide& a, const decn_wide& b){
+	if (a.nan_ || b.nan_){
+		return false;
+	}
+	if (a.neg_ != b.neg_){
+		return a.neg_;
+	}
+	int cmp = decn_wide::compare_mag(a, b);
+	return a.neg_ ? (cmp > 0) : (cmp < 0);
+}
+
+decn_wide operator-(const decn_wide& x){
+	decn_wide neg = x;
+	if (!neg.is_zero()){
+		neg.neg_ = !neg.neg_;
+	}
+	return neg;
+}
+
+decn_wide abs(const decn_wide& x){
+	decn_wide pos = x;
+	pos.neg_ = false;
+	return pos;
+}
+
+//a + b, with b's sign replaced by b_neg
+decn_wide decn_wide::add_signed(const decn_wide& a, const decn_wide& b, bool b_neg){
+	if (a.nan_ || b.nan_){
+		return nan();
+	}
+	if (b.is_zero()){
+		decn_wide res = a;
+		res.round_to(Precision);
+		return res;
+	}
+	if (a.is_zero()){
+		decn_wide res = b;
+		res.neg_ = b_neg;
+		res.round_to(Precision);
+		return res;
+	}
+	//big has the larger magnitude
+	bool swap = compare_mag(a, b) < 0;
+	const decn_wide& big = swap ? b : a;
+	const decn_wide& small = swap ? a : b;
+	bool big_neg = swap ? b_neg : a.neg_;
+	bool small_neg = swap ? a.neg_ : b_neg;
+
+	//buf[0] for the carry, then the digit100s of big, with 2 guard digit100s
+	size_t n = Precision + 3;
+	limb_buf buf(n);
+	for (size_t i = 0; i < big.num_lsu_ && i + 1 < n; i++){
+		buf.lsu[i + 1] = big.lsu_[i];
+	}
+	//small's digit100 i goes to buf[1 + shift + i] (beyond the guard digit100s is dropped)
+	size_t shift = big.exponent_ - small.exponent_;
+	if (shift < n){
+		size_t end = std::min(small.num_lsu_, n - 1 - shift);
+		if (big_neg == small_neg){
+			uint8_t carry = 0;
+			for (size_t i = end; i-- > 0; ){
+				uint8_t& digit100 = buf.lsu[1 + shift + i];
+				digit100 += small.lsu_[i] + carry;
+				carry = (digit100 >= 100);
+				if (carry){
+					digit100 -= 100;
+				}
+			}
+			for (size_t i = shift; carry; i--){
+				uint8_t& digit100 = buf.lsu[i];
+				digit100 += carry;
+				carry = (digit100 >= 100);
+				if (carry){
+					digit100 -= 100;
+				}
+			}
+		} else {
+			//|big| >= |small|, so there is no borrow out of buf[1]
+			uint8_t borrow = 0;
+			for (size_t i = end; i-- > 0; ){
+				uint8_t& digit100 = buf.lsu[1 + shift + i];
+				uint8_t sub = small.lsu_[i] + borrow;
+				borrow = (digit100 < sub);
+				digit100 += borrow ? 100 - sub : -sub;
+			}
+			for (size_t i = shift; borrow; i--){
+				uint8_t& digit100 = buf.lsu[i];
+				borrow = (digit100 == 0);
+				digit100 = borrow ? 99 : digit100 - 1;
+			}
+		}
+	}
+	return make(buf.lsu, n, big.exponent_ + 1, big_neg);
+}
+
+decn_wide operator+(const decn_wide& a, const decn_wide& b){
+	return decn_wide::add_signed(a, b, b.neg_);
+}
+
+decn_wide operator-(const decn_wide& a, const decn_wide& b){
+	return decn_wide::add_signed(a, b, !b.neg_);
+}
+
+decn_wide operator*(const decn_wide& a, const decn_wide& b){
+	if (a.nan_ || b.nan_){
+		return decn_wide::nan();
+	}
+	if (a.is_zero() || b.is_zero()){
+		return decn_wide();
+	}
+	//1 guard digit100 beyond the precision
+	size_t na = std::min(a.num_lsu_, Precision + 1);
+	size_t nb = std::min(b.num_lsu_, Precision + 1);
+	size_t n = std::max(na, nb);
+	size_t num_coeffs = na + nb - 1;
+	bool karatsuba = std::min(na, nb) > DECN_WIDE_KARATSUBA_NUM_LSU;
+	if (karatsuba){
+		num_coeffs = 2 * n - 1;
+	}
+	std::vector<uint64_t>& scratch = MultScratch;
+	size_t scratch_size = 2 * n + num_coeffs + (karatsuba ? karatsuba_scratch_size(n) : 0);
+	if (scratch.size() < scratch_size){
+		scratch.resize(scratch_size);
+	}
+	uint64_t* a_coeffs = scratch.data();
+	uint64_t* b_coeffs = a_coeffs + n;
+	uint64_t* c = b_coeffs + n;
+	for (size_t i = 0; i < n; i++){
+		a_coeffs[i] = (i < na) ? a.lsu_[i] : 0;
+		b_coeffs[i] = (i < nb) ? b.lsu_[i] : 0;
+	}
+	if (karatsuba){
+		mult_karatsuba(c, a_coeffs, b_coeffs, n, c + num_coeffs);
+	} else {
+		mult_schoolbook(c, a_coeffs, na, b_coeffs, nb);
+	}
+
+	//coefficient i is the digit100 at 100^-(i + 2): propagate carries
+	size_t len = na + nb;
+	limb_buf buf(len);
+	uint64_t carry = 0;
+	for (size_t i = len - 1; i > 0; i--){
+		uint64_t sum = c[i - 1] + carry;
+		buf.lsu[i] = sum % 100;
+		carry = sum / 100;
+	}
+	buf.lsu[0] = carry;
+	return decn_wide::make(buf.lsu, len, a.exponent_ + b.exponent_, a.neg_ != b.neg_);
+}
+
+decn_wide div_int(const decn_wide& a, uint32_t d){
+	if (a.nan_ || d == 0){
+		return decn_wide::nan();
+	}
+	size_t n = Precision + 2;
+	limb_buf buf(n);
+	uint64_t rem = 0;
+	for (size_t i = 0; i < n; i++){
+		rem = rem * 100 + ((i < a.num_lsu_) ? a.lsu_[i] : 0);
+		buf.lsu[i] = rem / d;
+		rem %= d;
+	}
+	return decn_wide::make(buf.lsu, n, a.exponent_, a.neg_);
+}
+
+decn_wide recip(const decn_wide& x){
+	if (x.nan_ || x.is_zero()){
+		return decn_wide::nan();
+	}
+	size_t num_lsu = Precision;
+	double m;
+	int32_t exponent;
+	x.to_double_parts(m, exponent);
+	decn_wide y = decn_wide::from_double(1 / m, -exponent);
+	//Newton-Raphson: y += y * (1 - x * y)
+	for (size_t p : newton_precisions(num_lsu + 2)){
+		decn_wide::scoped_precision precision(p);
+		y += y * (1 - x * y);
+	}
+	y.round_to(num_lsu);
+	return y;
+}
+
+decn_wide operator/(const decn_wide& a, const decn_wide& b){
+	decn_wide quot;
+	{
+		decn_wide::scoped_precision precision(Precision + 2);
+		quot = a * recip(b);
+	}
+	quot.round_to(Precision);
+	return quot;
+}
+
+decn_wide sqrt(const decn_wide& x){
+	if (x.nan_ || x.neg_){
+		return decn_wide::nan();
+	}
+	if (x.is_zero()){
+		return x;
+	}
+	size_t num_lsu = Precision;
+	double m;
+	int32_t exponent;
+	x.to_double_parts(m, exponent);
+	if (exponent & 1){
+		m *= 100;
+		exponent--;
+	}
+	decn_wide y = decn_wide::from_double(1 / std::sqrt(m), -exponent / 2);
+	//Newton-Raphson for 1/sqrt(x): y += y * (1 - x * y^2) / 2
+	for (size_t p : newton_precisions(num_lsu + 2)){
+		decn_wide::scoped_precision precision(p);
+		y += div_int(y * (1 - x * y * y), 2);
+	}
+	decn_wide res;
+	{
+		decn_wide::scoped_precision precision(num_lsu + 2);
+		res = x * y;
+	}
+	res.round_to(num_lsu);
+	return res;
+}
+
+bool decn_wide::exp_special(const decn_wide& x, decn_wide& res){
+	if (x.nan_){
+		res = x;
+	} else if (x.is_zero()){
+		res = decn_wide(1);
+	} else if (x.exponent_ > 5){
+		//e^x would overflow the exponent, for |x| > ~9.9e9
+		res = x.neg_ ? decn_wide() : nan();
+	} else {
+		return false;
+	}
+	return true;
+}
+
+decn_wide exp_taylor(const decn_wide& x){
+	decn_wide sum;
+	if (decn_wide::exp_special(x, sum)){
+		return sum;
+	}
+	size_t num_lsu = Precision;
+	//e^x = (e^(x / 2^k))^(2^k): reduce until the Taylor series converges quickly,
+	// the number of halvings balances the number of terms against the squarings
+	double x_abs = std::fabs(x.to_double());
+	int k = (int) std::sqrt(num_lsu * 6.64);
+	if (x_abs > 1){
+		k += std::ilogb(x_abs) + 1;
+	}
+	//each squaring doubles the relative error (about 6.6 squarings per digit100),
+	// and the absolute error of x/2^k is the relative error of the result
+	size_t guard = 2 + k / 6 + std::max(x.exponent_, 0);
+
+	{
+		decn_wide::scoped_precision precision(num_lsu + guard);
+		decn_wide r = x;
+		for (int i = 0; i < k; i += 16){
+			r = div_int(r, 1u << std::min(k - i, 16));
+		}
+		//Taylor series
+		decn_wide term(1);
+		sum = term;
+		for (uint32_t i = 1; ; i++){
+			term = div_int(term * r, i);
+			if (term.is_zero() || term.exponent_ < sum.exponent_ - (int32_t) (num_lsu + guard)){
+				break;
+			}
+			sum += term;
+		}
+		for (int i = 0; i < k; i++){
+			sum = sum * sum;
+		}
+	}
+	sum.round_to(num_lsu);
+	return sum;
+}
+
+decn_wide exp_newton(const decn_wide& x){
+	decn_wide y;
+	if (decn_wide::exp_special(x, y)){
+		return y;
+	}
+	size_t num_lsu = Precision;
+	//the absolute error of x - ln(y) is the relative error of the result
+	size_t guard = 2 + std::max(x.exponent_, 0);
+	std::vector<size_t> precisions = newton_precisions(num_lsu + guard);
+	{
+		decn_wide::scoped_precision precision(precisions[0]);
+		y = exp_taylor(x);
+	}
+	//Newton-Raphson: y += y * (x - ln(y))
+	for (size_t i = 1; i < precisions.size(); i++){
+		decn_wide::scoped_precision precision(precisions[i]);
+		y += y * (x - ln_agm(y));
+	}
+	y.round_to(num_lsu);
+	return y;
+}
+
+decn_wide exp(const decn_wide& x){
+	if (Precision >= DECN_WIDE_NEWTON_EXP_NUM_LSU){
+		return exp_newton(x);
+	}
+	return exp_taylor(x);
+}
+
+bool decn_wide::ln_special(const decn_wide& x, decn_wide& res, size_t& guard){
+	if (x.nan_ || x.neg_ || x.is_zero()){
+		res = nan();
+		return true;
+	}
+	res = x - 1;
+	guard = 2 + std::max(-res.exponent_, 0);
+	return res.is_zero();
+}
+
+decn_wide ln_newton(const decn_wide& x){
+	decn_wide y;
+	size_t guard;
+	if (decn_wide::ln_special(x, y, guard)){
+		return y;
+	}
+	size_t num_lsu = Precision;
+	double y_seed;
+	if (y.exponent_ <= 0 && std::fabs(y.to_double()) < 0.5){
+		y_seed = std::log1p(y.to_double());
+	} else {
+		double m;
+		int32_t exponent;
+		x.to_double_parts(m, exponent);
+		y_seed = std::log(m) + exponent * std::log(100.0);
+	}
+	y = decn_wide::from_double(y_seed, 0);
+	//Newton-Raphson: y += x * e^-y - 1
+	for (size_t p : newton_precisions(num_lsu + 2)){
+		decn_wide::scoped_precision precision(p + guard - 2);
+		y += x * exp_taylor(-y) - 1;
+	}
+	y.round_to(num_lsu);
+	return y;
+}
+
+decn_wide ln_agm(const decn_wide& x){
+	decn_wide res;
+	size_t guard;
+	if (decn_wide::ln_special(x, res, guard)){
+		return res;
+	}
+	size_t num_lsu = Precision;
+	//(ln(s) below is about 2.3 * num_lsu, and m * ln(100) cancels most of it)
+	size_t work_num_lsu = num_lsu + guard + 2;
+	{
+		decn_wide::scoped_precision precision(work_num_lsu);
+		//s = x * 100^m is large enough that ln(s) = pi / (2 AGM(1, 4/s)) to all
+		// digits (the error is about 1/s^2)
+		int32_t m = (int32_t) (work_num_lsu / 2 + 1) - x.exponent_;
+		decn_wide s = x;
+		s.exponent_ += m;
+		decn_wide a(1);
+		decn_wide b = decn_wide(4) / s;
+		//converges quadratically, once a and b agree in their first digits
+		while (!(a - b).is_zero() && (a - b).exponent_ >= a.exponent_ - (int32_t) (work_num_lsu / 2)){
+			decn_wide a_next = div_int(a + b, 2);
+			b = sqrt(a * b);
+			a = a_next;
+		}
+		a = div_int(a + b, 2);
+		//ln(x) = ln(s) - m ln(100)
+		res = div_int(decn_wide::pi() / a, 2) - decn_wide(m) * (2 * decn_wide::ln10());
+	}
+	res.round_to(num_lsu);
+	return res;
+}
+
+decn_wide ln(const decn_wide& x){
+	if (Precision >= DECN_WIDE_AGM_NUM_LSU){
+		return ln_agm(x);
+	}
+	return ln_newton(x);
+}
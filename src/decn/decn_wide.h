@@ -0,0 +1,159 @@
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * decn_wide.h
+ *
+ * wide decimal numbers (desktop only, C++): base 100 digit100s like dec80, but
+ * with a number of digit100s chosen at run time (e.g. 25 for 50 digits, or 250
+ * for 500 digits), for checking the 18 digit decn functions against high
+ * precision results
+ */
+
+#ifndef SRC_DEC_DECN_WIDE_H_
+#define SRC_DEC_DECN_WIDE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include "decn.h"
+
+
+//default number of digit100s (50 digits)
+#define DECN_WIDE_DEFAULT_NUM_LSU 25
+
+//above this many digit100s, multiplication uses Karatsuba instead of schoolbook
+#define DECN_WIDE_KARATSUBA_NUM_LSU 32
+//from this many digit100s, ln() uses the AGM instead of Newton-Raphson on exp_taylor()
+#define DECN_WIDE_AGM_NUM_LSU 250
+//from this many digit100s, exp() uses Newton-Raphson on ln_agm() instead of a Taylor series
+#define DECN_WIDE_NEWTON_EXP_NUM_LSU 2000
+
+class decn_wide {
+public:
+	//number of digit100s of new values, and of the results of the decn_wide
+	// functions, for the current thread
+	static size_t precision();
+	static void set_precision(size_t num_lsu);
+
+	//set the precision until the end of the scope
+	class scoped_precision {
+	public:
+		explicit scoped_precision(size_t num_lsu);
+		~scoped_precision();
+		scoped_precision(const scoped_precision&) = delete;
+		scoped_precision& operator=(const scoped_precision&) = delete;
+	private:
+		size_t prev_num_lsu;
+	};
+
+	decn_wide(); //zero
+	decn_wide(int32_t x);
+	explicit decn_wide(const dec80& x);
+	//e.g. "-1.25", "123e-45" (invalid strings give NaN)
+	explicit decn_wide(const char* str);
+	decn_wide(const decn_wide& x);
+	decn_wide(decn_wide&& x) noexcept;
+	decn_wide& operator=(const decn_wide& x);
+	decn_wide& operator=(decn_wide&& x) noexcept;
+	~decn_wide();
+
+	static decn_wide nan();
+	//constants, by binary splitting (cached for the current thread)
+	static decn_wide pi();
+	static decn_wide ln10();
+
+	bool is_zero() const { return !nan_ && num_lsu_ == 0; }
+	bool is_nan() const { return nan_; }
+	bool is_neg() const { return neg_; }
+
+	//round to 18 digits (NaN if too large for a dec80, 0 if too small)
+	void to_dec80(dec80* dest) const;
+	//scientific notation, rounded to num_digits digits, e.g. "-1.2345e-6"
+	std::string to_string(size_t num_digits) const;
+	double to_double() const;
+
+	friend decn_wide operator-(const decn_wide& x);
+	friend decn_wide operator+(const decn_wide& a, const decn_wide& b);
+	friend decn_wide operator-(const decn_wide& a, const decn_wide& b);
+	friend decn_wide operator*(const decn_wide& a, const decn_wide& b);
+	friend decn_wide operator/(const decn_wide& a, const decn_wide& b);
+	//a / d for small integers d
+	friend decn_wide div_int(const decn_wide& a, uint32_t d);
+
+	friend decn_wide abs(const decn_wide& x);
+	friend decn_wide recip(const decn_wide& x);
+	friend decn_wide sqrt(const decn_wide& x);
+	//ln() and exp() select one of the algorithms below by the precision
+	friend decn_wide ln(const decn_wide& x);
+	friend decn_wide exp(const decn_wide& x);
+	//Newton-Raphson on exp_taylor()
+	friend decn_wide ln_newton(const decn_wide& x);
+	//arithmetic-geometric mean: ln(s) ~ pi / (2 AGM(1, 4/s)) for large s
+	friend decn_wide ln_agm(const decn_wide& x);
+	//Taylor series, after halving x
+	friend decn_wide exp_taylor(const decn_wide& x);
+	//Newton-Raphson on ln_agm()
+	friend decn_wide exp_newton(const decn_wide& x);
+
+	//comparisons are false if either value is NaN
+	friend bool operator==(const decn_wide& a, const decn_wide& b);
+	friend bool operator<(const decn_wide& a, const decn_wide& b);
+
+	decn_wide& operator+=(const decn_wide& x) { return *this = *this + x; }
+	decn_wide& operator-=(const decn_wide& x) { return *this = *this - x; }
+	decn_wide& operator*=(const decn_wide& x) { return *this = *this * x; }
+	decn_wide& operator/=(const decn_wide& x) { return *this = *this / x; }
+
+private:
+	//value is 0.lsu_[0] lsu_[1] ... (base 100) * 100^exponent_
+	//lsu_[0] and lsu_[num_lsu_ - 1] are non-zero, and zero has no digit100s
+	//digit100s are always binary (0 to 99), even with DECN_PACKED_BCD
+	int32_t exponent_;
+	bool neg_;
+	bool nan_;
+	size_t num_lsu_;
+	size_t capacity_;
+	uint8_t* lsu_; //from the limb pool
+
+	void alloc(size_t num_lsu);
+	void release();
+	//round to num_lsu digit100s
+	void round_to(size_t num_lsu);
+
+	//value 0.buf[0] buf[1] ... (base 100) * 100^exponent, normalized and
+	// rounded to the current precision
+	static decn_wide make(const uint8_t* buf, size_t n, int32_t exponent, bool neg);
+	//value 0.digits[0] digits[1] ... (base 10) * 10^exponent
+	static decn_wide from_digits(const uint8_t* digits, size_t n, int32_t exponent, bool neg);
+	//value m * 100^exponent
+	static decn_wide from_double(double m, int32_t exponent);
+	//m * 100^exponent, with 0.01 <= |m| < 1
+	void to_double_parts(double& m, int32_t& exponent) const;
+	//num_digits decimal digits rounded, for value 0.digits * 10^exponent
+	void round_digits(uint8_t* digits, size_t num_digits, int32_t& exponent) const;
+	//results of exp() and ln() for NaN, 0, etc., return false for other values
+	static bool exp_special(const decn_wide& x, decn_wide& res);
+	//(also returns the number of guard digit100s needed near 1: ln(x) ~ x - 1)
+	static bool ln_special(const decn_wide& x, decn_wide& res, size_t& guard);
+	static decn_wide add_signed(const decn_wide& a, const decn_wide& b, bool b_neg);
+	static int compare_mag(const decn_wide& a, const decn_wide& b);
+};
+
+inline bool operator!=(const decn_wide& a, const decn_wide& b) { return !a.is_nan() && !b.is_nan() && !(a == b); }
+inline bool operator>(const decn_wide& a, const decn_wide& b) { return b < a; }
+inline bool operator<=(const decn_wide& a, const decn_wide& b) { return a < b || a == b; }
+inline bool operator>=(const decn_wide& a, const decn_wide& b) { return b < a || a == b; }
+
+
+#endif /* SRC_DEC_DECN_WIDE_H_ */
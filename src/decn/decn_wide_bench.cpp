@@ -0,0 +1,77 @@
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * decn_wide_bench.cpp
+ *
+ * times the decn_wide algorithms for ln(), exp() and the constants across
+ * numbers of digit100s, to choose DECN_WIDE_AGM_NUM_LSU and
+ * DECN_WIDE_NEWTON_EXP_NUM_LSU
+ */
+
+#include <stdio.h>
+#include <chrono>
+#include <functional>
+#include "decn_wide.h"
+
+
+static double seconds(){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//time per call of fn in ms, repeated for at least 0.2s
+static double time_ms(const std::function<void()>& fn){
+	int num_calls = 0;
+	double start = seconds(), time;
+	do {
+		fn();
+		num_calls++;
+		time = seconds() - start;
+	} while (time < 0.2);
+	return time / num_calls * 1e3;
+}
+
+//time of the first call in ms (the constants are cached after that)
+static double time_once_ms(const std::function<void()>& fn){
+	double start = seconds();
+	fn();
+	return (seconds() - start) * 1e3;
+}
+
+int main(void){
+	static const size_t NUM_LSU[] = {9, 25, 50, 100, 250, 500, 1000, 2000, 4000};
+	const decn_wide x("0.1234567890123456789");
+	const decn_wide y("1234.567890123456789");
+
+	printf("%6s %9s %9s %9s %9s %9s %9s %9s %9s  (ms)\n", "digits",
+		"mult", "pi", "ln10", "ln_newton", "ln_agm", "exp_taylr", "exp_newtn", "recip");
+	for (size_t num_lsu : NUM_LSU){
+		decn_wide::set_precision(num_lsu);
+		//full length arguments
+		decn_wide a = recip(y), b = sqrt(y);
+		decn_wide res;
+		printf("%6zu", 2 * num_lsu);
+		printf(" %9.4f", time_ms([&]{ res = a * b; }));
+		printf(" %9.4f", time_once_ms([&]{ res = decn_wide::pi(); }));
+		printf(" %9.4f", time_once_ms([&]{ res = decn_wide::ln10(); }));
+		printf(" %9.4f", time_ms([&]{ res = ln_newton(a); }));
+		printf(" %9.4f", time_ms([&]{ res = ln_agm(a); }));
+		printf(" %9.4f", time_ms([&]{ res = exp_taylor(x); }));
+		printf(" %9.4f", time_ms([&]{ res = exp_newton(x); }));
+		printf(" %9.4f", time_ms([&]{ res = recip(b); }));
+		printf("\n");
+		fflush(stdout);
+	}
+
+	return 0;
+}
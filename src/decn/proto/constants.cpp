@@ -0,0 +1,137 @@
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+//generates the constants used by decn.c
+// each constant is rounded (or truncated) to 2*DEC80_NUM_LSU digits, and printed as the
+// initializer for a dec80 so it can be pasted into decn.c
+// (dividing by a constant is a multiply by its precomputed reciprocal instead)
+//uses decn_wide (pi and ln(10) by binary splitting), and the sizes from decn.h,
+// so the constants can be regenerated after changing DEC80_NUM_LSU
+
+#include <stdio.h>
+#include <iostream>
+#include <string>
+#include "../decn_wide.h"
+
+using std::cout;
+using std::endl;
+
+
+//first num_digits digits of x (> 0), and exponent such that x = d0.d1 d2 ... * 10^exponent
+static std::string get_digits(const decn_wide& x, int num_digits, bool round, int& exponent){
+	//(all digits of x, when truncating)
+	std::string str = x.to_string(round ? num_digits : 2 * decn_wide::precision());
+	size_t e = str.find('e');
+	exponent = std::stoi(str.substr(e + 1));
+	std::string digits = str.substr(0, 1) + str.substr(2, e - 2);
+	digits.resize(num_digits, '0');
+	return digits;
+}
+
+//print x (> 0) rounded or truncated to 2*DEC80_NUM_LSU digits
+static void print_const(const char* comment, const char* name, const decn_wide& x, bool round = true){
+	int exponent;
+	std::string digits = get_digits(x, 2 * DEC80_NUM_LSU, round, exponent);
+
+	cout << "// " << comment << endl;
+	cout << "const dec80 " << name << " = {" << endl << "\t";
+	if (exponent < 0){
+		cout << exponent << " & 0x7fff";
+	} else {
+		cout << exponent;
+	}
+	cout << ", DEC80_LSU(";
+	for (int i = 0; i < DEC80_NUM_LSU; i++){
+		char buf[8];
+		snprintf(buf, sizeof buf, "%2d", (digits[2 * i] - '0') * 10 + (digits[2 * i + 1] - '0'));
+		cout << buf << (i < DEC80_NUM_LSU - 1 ? ", " : ")");
+	}
+	cout << endl << "};" << endl << endl;
+}
+
+//print x (0 <= x < 10) truncated to a decn_fixed (2*DECN_FIXED_NUM_LSU - 1 decimal places)
+static void print_fixed(const decn_wide& x){
+	int exponent = 0;
+	std::string digits = get_digits(x, 2 * DECN_FIXED_NUM_LSU, false, exponent);
+	cout << "DECN_FIXED_LSU(";
+	for (int i = 0; i < DECN_FIXED_NUM_LSU; i++){
+		//digit k is at 10^-k
+		int digit100 = 0;
+		for (int k = 2 * i; k < 2 * i + 2; k++){
+			int idx = k + exponent;
+			digit100 = digit100 * 10 + ((idx >= 0 && !x.is_zero()) ? digits[idx] - '0' : 0);
+		}
+		char buf[8];
+		snprintf(buf, sizeof buf, "%2d", digit100);
+		cout << buf << (i < DECN_FIXED_NUM_LSU - 1 ? ", " : ")");
+	}
+}
+
+//atan(x), by its Taylor series (x must be small, except for atan(1) == pi/4)
+static decn_wide atan_series(const decn_wide& x){
+	const decn_wide x2 = x * x;
+	decn_wide term = x;
+	decn_wide sum = x;
+	for (uint32_t n = 3; !term.is_zero(); n += 2){
+		term = -(term * x2);
+		decn_wide next = sum + div_int(term, n);
+		if (next == sum){
+			break;
+		}
+		sum = next;
+	}
+	return sum;
+}
+
+int main(void){
+	//(plenty of guard digits)
+	decn_wide::set_precision(2 * DECN_FIXED_NUM_LSU + 10);
+	const decn_wide ln_10 = decn_wide::ln10();
+	const decn_wide pi = decn_wide::pi();
+
+	print_const("ln(10) constant", "DECN_LN_10", ln_10);
+	print_const("1/ln(10) constant (truncated, not rounded, see exp_decn())", "DECN_1_LN_10", 1 / ln_10, false);
+	print_const("pi", "DECN_PI", pi);
+	print_const("180/pi = 1rad in degree", "DECN_1RAD", 180 / pi);
+	print_const("pi/180 = 1 degree in rad", "DECN_1DEG", div_int(pi, 180));
+
+	cout << "// ln(1 + 10^-j), truncated to " << 2 * DECN_FIXED_NUM_LSU - 1 << " decimal places" << endl;
+	cout << "static const decn_fixed LN_A_ARR[DECN_NUM_LN_A_ARR] = {" << endl;
+	decn_wide pow10(1);
+	for (int j = 0; j < DECN_NUM_LN_A_ARR; j++){
+		cout << "\t";
+		print_fixed(ln(1 + pow10));
+		cout << "," << endl;
+		pow10 = div_int(pow10, 10);
+	}
+	cout << "};" << endl << endl;
+
+	cout << "// atan(10^-j), truncated to " << 2 * DECN_FIXED_NUM_LSU - 1 << " decimal places" << endl;
+	cout << "static const decn_fixed ATAN_A_ARR[DECN_NUM_ATAN_A_ARR] = {" << endl;
+	pow10 = 1;
+	for (int j = 0; j < DECN_NUM_ATAN_A_ARR; j++){
+		cout << "\t";
+		print_fixed(j == 0 ? div_int(pi, 4) : atan_series(pow10));
+		cout << "," << endl;
+		pow10 = div_int(pow10, 10);
+	}
+	cout << "};" << endl << endl;
+
+	cout << "// ln(10), truncated to " << 2 * DECN_FIXED_NUM_LSU - 1 << " decimal places" << endl;
+	cout << "static const decn_fixed LN_10_FIXED = ";
+	print_fixed(ln_10);
+	cout << ";" << endl;
+
+	return 0;
+}
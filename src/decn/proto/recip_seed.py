@@ -0,0 +1,31 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Calculate the initial estimate table used by recip_decn()
+
+The table is indexed by the most significant digit100 d (10 to 99) of x,
+i.e. the significand of x is between d/10 and (d+1)/10. The estimate of the
+significand of 1/x (with exponent -exponent(x) - 1) minimizes the maximum
+relative error over that interval: 2/(d/10 + (d+1)/10) * 10 = 200/(2d + 1),
+rounded to 2 digits.
+"""
+
+from fractions import Fraction
+
+max_err = 0
+entries = []
+for d in range(10, 100):
+    est = Fraction(200, 2 * d + 1)
+    digit100 = round(est * 10)
+    assert 10 <= digit100 <= 99
+    entries.append(digit100)
+    #worst relative error of the estimate at either end of the interval
+    for x in (Fraction(d, 10), Fraction(d + 1, 10)):
+        err = abs(Fraction(digit100, 10) * x / 10 - 1)
+        max_err = max(max_err, err)
+
+print("static const uint8_t RECIP_EST[90] = {")
+for i in range(0, len(entries), 10):
+    print("\t" + " ".join("%2d," % e for e in entries[i:i + 10]))
+print("};")
+print("max relative error: %g" % float(max_err))
@@ -0,0 +1,114 @@
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+//prototype for sin/cos functions
+// decimal CORDIC (pseudo-division/pseudo-multiplication) based on HP Journal article
+// "Personal Calculator Algorithms II: Trigonometric Functions"
+// (same structure as ln()/exp(), with atan(10^-j) instead of ln(1 + 10^-j))
+
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include <boost/multiprecision/mpfr.hpp>
+using namespace boost::multiprecision;
+
+// #define DEBUG
+// #define DEBUG_ALL
+
+using std::cout;
+using std::endl;
+
+static const int NUM_A_ARR = 9;
+mpfr_float atan_a_arr[NUM_A_ARR];
+
+static const unsigned int CALC_PRECISION = 18;
+
+
+int main(void){
+	cout << std::scientific << std::setprecision(CALC_PRECISION);
+	//initiallize atan_a_arr
+	for (int j = 0; j < NUM_A_ARR; j++){
+		// atan_a[j] = atan(10^-j)
+		mpfr_float a(-j, CALC_PRECISION);
+		a = pow(10, a);
+		atan_a_arr[j] = atan(a);
+		cout << j << endl;
+		cout << " atan(a):" << atan_a_arr[j] << endl;
+	}
+	cout << endl << endl ;
+	//loop through values to test
+	mpfr_float half_pi = boost::math::constants::pi<mpfr_float>() / 2;
+	for (mpfr_float x(0.0001, CALC_PRECISION); x < half_pi; x += 0.0009765625){
+		//build mpf values
+		mpfr_float accum(x, CALC_PRECISION);
+		mpfr_float save (0, CALC_PRECISION);
+		mpfr_float_1000 actual_sin, actual_cos;
+		actual_sin = sin(x);
+		actual_cos = cos(x);
+
+		int num_times[NUM_A_ARR];
+		//pseudo-divide: track number of times atan_a_arr[j] subtracted
+		for (int j = 0; j < NUM_A_ARR; j++){
+			int k_j = 0;
+			while (accum > 0){
+				save = accum;
+				accum -= atan_a_arr[j];
+				k_j++;
+			}
+			num_times[j] = k_j - 1;
+			accum = save; //restore
+#ifdef DEBUG
+			printf("  %d: num_times: %d, ", j, num_times[j]);
+			cout << accum << endl;
+#endif
+		}
+
+		//pseudo-multiply: rotate (1, remainder) by the angles atan(10^-j)
+		mpfr_float y(save, CALC_PRECISION); //small angle: sin(r) ~= r
+		mpfr_float z(1, CALC_PRECISION);    //small angle: cos(r) ~= 1
+		for (int j = NUM_A_ARR - 1; j >= 0; j--){
+			mpfr_float scale(-j, CALC_PRECISION);
+			scale = pow(10, scale);
+			for (int k = 0; k < num_times[j]; k++){
+				mpfr_float y_new = y + z * scale;
+				z -= y * scale;
+				y = y_new;
+#ifdef DEBUG_ALL
+				printf("     %d %d: ", j, k);
+				cout << y << ", " << z << endl;
+#endif
+			}
+		}
+
+		//calculate relative error (after removing CORDIC gain)
+		mpfr_float_1000 calc_sin(y), calc_cos(z), r, diff;
+		r = sqrt(calc_sin*calc_sin + calc_cos*calc_cos);
+		calc_sin /= r;
+		calc_cos /= r;
+		diff = abs(actual_sin - calc_sin) + abs(actual_cos - calc_cos);
+
+#ifdef DEBUG_ALL
+		if (1){
+#else
+		if (diff > 5e-17){
+#endif
+			cout << x << ": ";
+			cout << std::setprecision(18) << calc_sin << ", " << calc_cos << ", ";
+			cout << diff << endl;
+		}
+	}
+
+	return 0;
+}